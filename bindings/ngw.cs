@@ -1,6 +1,7 @@
 namespace ngw
 {
     using System;
+    using System.Collections.Generic;
     using System.Runtime.InteropServices;
 
     /// <summary>
@@ -33,6 +34,87 @@ namespace ngw
         {
             NativeMethods.ngw_add_binary_path(path);
         }
+
+        /// <summary>
+        /// Overrides rank of element "factory", auto-plugging prefers higher ranks
+        /// </summary>
+        public static bool setElementRank(string factory, uint rank)
+        {
+            return NativeMethods.ngw_set_element_rank(factory, rank);
+        }
+
+        /// <summary>
+        /// Splits "threads" between "decoders" video decoders of all players (0 threads lifts the cap)
+        /// </summary>
+        public static void setDecoderThreadBudget(uint threads, uint decoders)
+        {
+            NativeMethods.ngw_set_decoder_thread_budget(threads, decoders);
+        }
+
+        /// <summary>
+        /// Enables or disables the process-wide discovery cache (enabled by default)
+        /// </summary>
+        public static void setDiscoveryCacheEnabled(bool on)
+        {
+            NativeMethods.ngw_set_discovery_cache_enabled(on);
+        }
+
+        /// <summary>
+        /// Persists the discovery cache into "path" (null turns persistence off)
+        /// </summary>
+        public static void setDiscoveryCacheFile(string path)
+        {
+            NativeMethods.ngw_set_discovery_cache_file(path);
+        }
+
+        /// <summary>
+        /// Monotonic time in microseconds, time base of Player.update(vblank)
+        /// </summary>
+        public static long getMonotonicTime()
+        {
+            return NativeMethods.ngw_get_monotonic_time();
+        }
+
+        /// <summary>
+        /// Removes all entries of the discovery cache
+        /// </summary>
+        public static void clearDiscoveryCache()
+        {
+            NativeMethods.ngw_clear_discovery_cache();
+        }
+
+        /// <summary>
+        /// Turns the built-in tracer on or off (off by default)
+        /// </summary>
+        public static bool traceEnabled
+        {
+            get { return NativeMethods.ngw_get_trace_enabled(); }
+            set { NativeMethods.ngw_set_trace_enabled(value); }
+        }
+
+        /// <summary>
+        /// Merges records of GStreamer's latency tracer into the trace
+        /// </summary>
+        public static void setTraceGstLatency(bool on)
+        {
+            NativeMethods.ngw_set_trace_gst_latency(on);
+        }
+
+        /// <summary>
+        /// Writes recorded events into "path" as Chrome trace JSON
+        /// </summary>
+        public static bool dumpTrace(string path)
+        {
+            return NativeMethods.ngw_dump_trace(path);
+        }
+
+        /// <summary>
+        /// Discards all recorded events
+        /// </summary>
+        public static void clearTrace()
+        {
+            NativeMethods.ngw_clear_trace();
+        }
     }
 
     /// <summary>
@@ -52,11 +134,19 @@ namespace ngw
         GCHandle                            mErrorCallbackHandle;
         GCHandle                            mStateCallbackHandle;
         GCHandle                            mStEndCallbackHandle;
+        GCHandle                            mTrackCallbackHandle;
+        GCHandle                            mOpenedCallbackHandle;
+        GCHandle                            mSeekedCallbackHandle;
+        GCHandle                            mFrInfoCallbackHandle;
         GCHandle                            mFrameDirtyFlagHandle;
 
         public Action<NativeTypes.State>    OnStateChanged;
         public Action<string>               OnErrorReceived;
         public Action                       OnStreamEnded;
+        public Action<string>               OnTrackChanged;
+        public Action<bool>                 OnOpened;
+        public Action<double>               OnSeeked;
+        public Action<NativeTypes.FrameInfo> OnFrameInfo;
 
         #endregion
 
@@ -91,14 +181,47 @@ namespace ngw
                         OnStreamEnded();
                 });
 
+                var track_delegate = new NativeTypes.TrackChangedDelegate((uri, player) =>
+                {
+                    if (OnTrackChanged != null)
+                        OnTrackChanged(uri);
+                });
+
+                var opened_delegate = new NativeTypes.OpenedDelegate((success, player) =>
+                {
+                    if (OnOpened != null)
+                        OnOpened(success);
+                });
+
+                var seeked_delegate = new NativeTypes.SeekedDelegate((latency, player) =>
+                {
+                    if (OnSeeked != null)
+                        OnSeeked(latency);
+                });
+
+                // Descriptor is only marshaled if someone listens, this is called per frame
+                var frinfo_delegate = new NativeTypes.FrameInfoDelegate((info, buffer, size, player) =>
+                {
+                    if (OnFrameInfo != null)
+                        OnFrameInfo((NativeTypes.FrameInfo)Marshal.PtrToStructure(info, typeof(NativeTypes.FrameInfo)));
+                });
+
                 mErrorCallbackHandle = GCHandle.Alloc(error_delegate, GCHandleType.Pinned);
                 mStateCallbackHandle = GCHandle.Alloc(state_delegate, GCHandleType.Pinned);
                 mStEndCallbackHandle = GCHandle.Alloc(stend_delegate, GCHandleType.Pinned);
+                mTrackCallbackHandle = GCHandle.Alloc(track_delegate, GCHandleType.Pinned);
+                mOpenedCallbackHandle = GCHandle.Alloc(opened_delegate, GCHandleType.Pinned);
+                mSeekedCallbackHandle = GCHandle.Alloc(seeked_delegate, GCHandleType.Pinned);
+                mFrInfoCallbackHandle = GCHandle.Alloc(frinfo_delegate, GCHandleType.Pinned);
                 mFrameDirtyFlagHandle = GCHandle.Alloc(mFrameDirty, GCHandleType.Pinned);
 
                 NativeMethods.ngw_player_set_error_callback(mNativePlayer, error_delegate);
                 NativeMethods.ngw_player_set_state_callback(mNativePlayer, state_delegate);
                 NativeMethods.ngw_player_set_stream_end_callback(mNativePlayer, stend_delegate);
+                NativeMethods.ngw_player_set_track_changed_callback(mNativePlayer, track_delegate);
+                NativeMethods.ngw_player_set_opened_callback(mNativePlayer, opened_delegate);
+                NativeMethods.ngw_player_set_seeked_callback(mNativePlayer, seeked_delegate);
+                NativeMethods.ngw_player_set_frame_info_callback(mNativePlayer, frinfo_delegate);
                 NativeMethods.ngw_player_set_frame_dirty_flag(mNativePlayer, ref mFrameDirty);
             }
         }
@@ -123,11 +246,63 @@ namespace ngw
             return NativeMethods.ngw_player_open_resize_format(mNativePlayer, path, width, height, format);
         }
 
+        // Opens in the background, OnOpened is raised from update() once done
+        public bool openAsync(string path)
+        {
+            return NativeMethods.ngw_player_open_async(mNativePlayer, path);
+        }
+
+        public bool openAsync(string path, int width, int height, string format)
+        {
+            return NativeMethods.ngw_player_open_async_resize_format(mNativePlayer, path, width, height, format);
+        }
+
         public void setFrameBuffer(IntPtr pinned_frame_buffer, NativeTypes.Buffer type)
         {
             NativeMethods.ngw_player_set_frame_buffer(mNativePlayer, pinned_frame_buffer, type);
         }
 
+        // Bytes a Buffer.BytePointer frame buffer holds, frames that do not fit are dropped. 0 trusts it to hold a whole frame
+        public ulong frameBufferSize
+        {
+            set { NativeMethods.ngw_player_set_frame_buffer_size(mNativePlayer, (UIntPtr)value); }
+        }
+
+        // Frames are decoded straight into these pinned buffers of size bytes each, from next open(). Keep them pinned
+        // until close() and register at least frame queue depth + 6 of them. Null turns it off
+        public void setFramePool(IntPtr[] pinned_buffers, ulong size)
+        {
+            uint count = pinned_buffers != null ? (uint)pinned_buffers.Length : 0;
+            NativeMethods.ngw_player_set_frame_pool(mNativePlayer, pinned_buffers, count, (UIntPtr)size);
+        }
+
+        // Three pinned buffers of size bytes each, update() rotates frames through them. Frames that do not fit are dropped.
+        // Null turns it off
+        public void setTripleBuffer(IntPtr[] pinned_buffers, ulong size)
+        {
+            if (pinned_buffers != null && pinned_buffers.Length != 3)
+                throw new ArgumentException("Exactly three buffers are needed.", "pinned_buffers");
+
+            NativeMethods.ngw_player_set_triple_buffer(mNativePlayer, pinned_buffers, (UIntPtr)size);
+        }
+
+        // Newest frame written by update() and its sequence, IntPtr.Zero if none. Left untouched until releaseLatest()
+        public IntPtr acquireLatest(out ulong sequence)
+        {
+            return NativeMethods.ngw_player_acquire_latest(mNativePlayer, out sequence);
+        }
+
+        public void releaseLatest()
+        {
+            NativeMethods.ngw_player_release_latest(mNativePlayer);
+        }
+
+        // Index into setFramePool() buffers of the latest frame, -1 if it was copied into the frame buffer
+        public int framePoolIndex
+        {
+            get { return NativeMethods.ngw_player_get_frame_pool_index(mNativePlayer); }
+        }
+
         public int width
         {
             get { return NativeMethods.ngw_player_get_width(mNativePlayer); }
@@ -168,6 +343,13 @@ namespace ngw
             set { NativeMethods.ngw_player_set_time(mNativePlayer, value); }
         }
 
+        // Seeks snap to key frames while scrubbing. Turning it off seeks accurately
+        public bool scrubbing
+        {
+            get { return NativeMethods.ngw_player_get_scrubbing(mNativePlayer); }
+            set { NativeMethods.ngw_player_set_scrubbing(mNativePlayer, value); }
+        }
+
         public double rate
         {
             get { return NativeMethods.ngw_player_get_rate(mNativePlayer); }
@@ -179,6 +361,188 @@ namespace ngw
             get { return NativeMethods.ngw_player_get_duration(mNativePlayer); }
         }
 
+        public void setFrameQueue(NativeTypes.FrameQueue policy, uint depth)
+        {
+            NativeMethods.ngw_player_set_frame_queue(mNativePlayer, policy, depth);
+        }
+
+        public NativeTypes.FrameQueue frameQueuePolicy
+        {
+            get { return NativeMethods.ngw_player_get_frame_queue_policy(mNativePlayer); }
+        }
+
+        public uint frameQueueDepth
+        {
+            get { return NativeMethods.ngw_player_get_frame_queue_depth(mNativePlayer); }
+        }
+
+        internal IntPtr nativePlayer
+        {
+            get { return mNativePlayer; }
+        }
+
+        // Queues a media to be played gap-less after the current one
+        public bool enqueue(string path)
+        {
+            return NativeMethods.ngw_player_enqueue(mNativePlayer, path);
+        }
+
+        public void clearQueue()
+        {
+            NativeMethods.ngw_player_clear_queue(mNativePlayer);
+        }
+
+        public uint queueLength
+        {
+            get { return NativeMethods.ngw_player_get_queue_length(mNativePlayer); }
+        }
+
+        public string uri
+        {
+            get { return Marshal.PtrToStringAnsi(NativeMethods.ngw_player_get_uri(mNativePlayer)); }
+        }
+
+        // Keeps the native play-bin alive across close() / open() calls
+        public bool reusePipeline
+        {
+            get { return NativeMethods.ngw_player_get_reuse_pipeline(mNativePlayer); }
+            set { NativeMethods.ngw_player_set_reuse_pipeline(mNativePlayer, value); }
+        }
+
+        // Parses bus messages on a shared background thread, takes effect on next open()
+        public bool busThread
+        {
+            get { return NativeMethods.ngw_player_get_bus_thread(mNativePlayer); }
+            set { NativeMethods.ngw_player_set_bus_thread(mNativePlayer, value); }
+        }
+
+        // Off hands video frames off as fast as they are decoded. Takes effect on next open()
+        public bool sync
+        {
+            get { return NativeMethods.ngw_player_get_sync(mNativePlayer); }
+            set { NativeMethods.ngw_player_set_sync(mNativePlayer, value); }
+        }
+
+        // Lets decoders hand off padded frames, read them through frame layouts. Takes effect on next open()
+        public bool paddedFrames
+        {
+            get { return NativeMethods.ngw_player_get_padded_frames(mNativePlayer); }
+            set { NativeMethods.ngw_player_set_padded_frames(mNativePlayer, value); }
+        }
+
+        // Threads of video decoders, 0 follows Library.setDecoderThreadBudget(). Takes effect on next open()
+        public uint decoderThreads
+        {
+            get { return NativeMethods.ngw_player_get_decoder_threads(mNativePlayer); }
+            set { NativeMethods.ngw_player_set_decoder_threads(mNativePlayer, value); }
+        }
+
+        // Sets a property of decoders where they have it, null unsets it. Takes effect on next open()
+        public void setDecoderProperty(string name, string value)
+        {
+            NativeMethods.ngw_player_set_decoder_property(mNativePlayer, name, value);
+        }
+
+        // Average milliseconds spent per OpenGL texture upload inside update()
+        public double uploadTime
+        {
+            get { return NativeMethods.ngw_player_get_upload_time(mNativePlayer); }
+        }
+
+        // Average milliseconds spent per OpenGL texture upload on the background copy
+        public double uploadCopyTime
+        {
+            get { return NativeMethods.ngw_player_get_upload_copy_time(mNativePlayer); }
+        }
+
+        // Converter and scaler set up, takes effect on next open()
+        public NativeTypes.ConvertOptions convertOptions
+        {
+            get
+            {
+                NativeTypes.ConvertOptions options;
+                NativeMethods.ngw_player_get_convert_options(mNativePlayer, out options);
+                return options;
+            }
+            set { NativeMethods.ngw_player_set_convert_options(mNativePlayer, ref value); }
+        }
+
+        // Hands audio to readAudio() as interleaved PCM instead of the system output, null format restores it. Takes effect on next open()
+        public void setAudioTap(string format, int rate, int channels, uint latency)
+        {
+            NativeMethods.ngw_player_set_audio_tap(mNativePlayer, format, rate, channels, latency);
+        }
+
+        public bool audioTap
+        {
+            get { return NativeMethods.ngw_player_get_audio_tap(mNativePlayer); }
+        }
+
+        // Lock-free, meant for the audio thread (OnAudioFilterRead in Unity). Answers bytes copied, fewer than asked is an underrun
+        public ulong readAudio(IntPtr dst, ulong size)
+        {
+            return (ulong)NativeMethods.ngw_player_read_audio(mNativePlayer, dst, (UIntPtr)size);
+        }
+
+        // Same as readAudio(IntPtr, ulong) for an "F32LE" tap, answers samples copied
+        public int readAudio(float[] dst)
+        {
+            ulong bytes = (ulong)NativeMethods.ngw_player_read_audio(mNativePlayer, dst, (UIntPtr)((ulong)dst.Length * sizeof(float)));
+            return (int)(bytes / sizeof(float));
+        }
+
+        public ulong audioAvailable
+        {
+            get { return (ulong)NativeMethods.ngw_player_get_audio_available(mNativePlayer); }
+        }
+
+        // Pixels cropped off each edge before conversion and scaling. Changeable while playing
+        public void setCrop(int left, int top, int right, int bottom)
+        {
+            NativeMethods.ngw_player_set_crop(mNativePlayer, left, top, right, bottom);
+        }
+
+        public void getCrop(out int left, out int top, out int right, out int bottom)
+        {
+            NativeMethods.ngw_player_get_crop(mNativePlayer, out left, out top, out right, out bottom);
+        }
+
+        public uint getDroppedFrames(NativeTypes.FrameQueue policy)
+        {
+            return NativeMethods.ngw_player_get_dropped_frames(mNativePlayer, policy);
+        }
+
+        // Runtime counters, cheap enough to read every frame
+        public NativeTypes.PlayerStats stats
+        {
+            get
+            {
+                NativeTypes.PlayerStats player_stats;
+                NativeMethods.ngw_player_get_stats(mNativePlayer, out player_stats);
+                return player_stats;
+            }
+        }
+
+        /// <summary>
+        /// Leases the latest frame without copying it (null if there is none).
+        /// Frame buffer type must be NativeTypes.Buffer.FrameLease. Dispose the
+        /// returned frame as soon as its data is consumed.
+        /// </summary>
+        public Frame leaseFrame()
+        {
+            IntPtr native_frame = NativeMethods.ngw_player_lease_frame(mNativePlayer);
+            return native_frame == IntPtr.Zero ? null : new Frame(native_frame);
+        }
+
+        /// <summary>
+        /// Plane pointers, strides and offsets of the frame being delivered.
+        /// ONLY valid inside a frame callback (NativeTypes.Buffer.CallbackFunction).
+        /// </summary>
+        public bool getFrameLayout(out NativeTypes.FrameLayout layout)
+        {
+            return NativeMethods.ngw_player_get_frame_layout(mNativePlayer, out layout);
+        }
+
         // This is left unchanged if passed in buffer is an OpenGL texture
         public bool frameDirty
         {
@@ -193,6 +557,19 @@ namespace ngw
         public void replay() { NativeMethods.ngw_player_replay(mNativePlayer); }
         public void update() { NativeMethods.ngw_player_update(mNativePlayer); }
 
+        /// <summary>
+        /// Same as update(), presenting the frame due by the next vblank.
+        /// vblank is the predicted display time, see Library.getMonotonicTime()
+        /// </summary>
+        public void update(long vblank) { NativeMethods.ngw_player_update_vblank(mNativePlayer, vblank); }
+
+        // Seconds frames are handed off ahead of their due time, takes effect on next open
+        public double frameLead
+        {
+            get { return NativeMethods.ngw_player_get_frame_lead(mNativePlayer); }
+            set { NativeMethods.ngw_player_set_frame_lead(mNativePlayer, value); }
+        }
+
         #endregion
 
         #region IDisposable Support
@@ -217,6 +594,18 @@ namespace ngw
                     if (mStEndCallbackHandle.IsAllocated)
                         mStEndCallbackHandle.Free();
 
+                    if (mTrackCallbackHandle.IsAllocated)
+                        mTrackCallbackHandle.Free();
+
+                    if (mOpenedCallbackHandle.IsAllocated)
+                        mOpenedCallbackHandle.Free();
+
+                    if (mSeekedCallbackHandle.IsAllocated)
+                        mSeekedCallbackHandle.Free();
+
+                    if (mFrInfoCallbackHandle.IsAllocated)
+                        mFrInfoCallbackHandle.Free();
+
                     if (mFrameDirtyFlagHandle.IsAllocated)
                         mFrameDirtyFlagHandle.Free();
                 }
@@ -237,78 +626,58 @@ namespace ngw
     }
 
     /// <summary>
-    /// Wrapper GStreamer discoverer class, provides the same functionality
-    /// of its C++ counterpart. Use of this class is optional. You can
-    /// directly use DllImported methods inside NativeMethods class.
+    /// Lease of a video frame handed out by Player.leaseFrame(). Data stays
+    /// valid and untouched until the frame is disposed. Can be disposed from
+    /// any thread (a render thread for example).
     /// </summary>
-    public class Discoverer : IDisposable
+    public class Frame : IDisposable
     {
         #region Private Members
 
-        IntPtr mNativeDiscoverer = IntPtr.Zero;
+        IntPtr mNativeFrame = IntPtr.Zero;
+        bool mOwned = true;
 
         #endregion
 
-        #region Discoverer API
-
-        public Discoverer()
-        {
-            mNativeDiscoverer = NativeMethods.ngw_discoverer_make();
-        }
-
-        public bool open(string path)
-        {
-            return NativeMethods.ngw_discoverer_open(mNativeDiscoverer, path);
-        }
-
-        public int width
-        {
-            get { return NativeMethods.ngw_discoverer_get_width(mNativeDiscoverer); }
-        }
-
-        public int height
-        {
-            get { return NativeMethods.ngw_discoverer_get_height(mNativeDiscoverer); }
-        }
-
-        public bool seekable
-        {
-            get { return NativeMethods.ngw_discoverer_get_seekable(mNativeDiscoverer); }
-        }
-
-        public bool hasAudio
-        {
-            get { return NativeMethods.ngw_discoverer_get_has_audio(mNativeDiscoverer); }
-        }
+        #region Frame API
 
-        public bool hasVideo
+        internal Frame(IntPtr native_frame)
         {
-            get { return NativeMethods.ngw_discoverer_get_has_video(mNativeDiscoverer); }
+            mNativeFrame = native_frame;
         }
 
-        public float frameRate
+        // Non-owning wrapper, for frames only valid inside a native callback
+        internal Frame(IntPtr native_frame, bool owned)
         {
-            get { return NativeMethods.ngw_discoverer_get_frame_rate(mNativeDiscoverer); }
+            mNativeFrame = native_frame;
+            mOwned = owned;
         }
 
-        public double duration
+        public IntPtr data
         {
-            get { return NativeMethods.ngw_discoverer_get_duration(mNativeDiscoverer); }
+            get { return NativeMethods.ngw_frame_get_data(mNativeFrame); }
         }
 
-        public uint sampleRate
+        public uint size
         {
-            get { return NativeMethods.ngw_discoverer_get_sample_rate(mNativeDiscoverer); }
+            get { return NativeMethods.ngw_frame_get_size(mNativeFrame); }
         }
 
-        public uint bitRate
+        // Plane pointers, strides and offsets of the frame (I420 and NV12 have several planes)
+        public bool getLayout(out NativeTypes.FrameLayout layout)
         {
-            get { return NativeMethods.ngw_discoverer_get_bit_rate(mNativeDiscoverer); }
+            return NativeMethods.ngw_frame_get_layout(mNativeFrame, out layout);
         }
 
-        public string uri
+        // Layout, time stamps and sequence number of the frame
+        public NativeTypes.FrameInfo info
         {
-            get { return Marshal.PtrToStringAnsi(NativeMethods.ngw_discoverer_get_uri(mNativeDiscoverer)); }
+            get
+            {
+                NativeTypes.FrameInfo frame_info;
+                NativeMethods.ngw_frame_get_info(mNativeFrame, out frame_info);
+                return frame_info;
+            }
         }
 
         #endregion
@@ -320,18 +689,15 @@ namespace ngw
         {
             if (!mDisposedValue)
             {
-                if (disposing)
-                {
-                    // no managed resources to be freed.
-                }
+                if (mOwned)
+                    NativeMethods.ngw_frame_release(mNativeFrame);
 
-                NativeMethods.ngw_discoverer_free(mNativeDiscoverer);
-                mNativeDiscoverer = IntPtr.Zero;
+                mNativeFrame = IntPtr.Zero;
                 mDisposedValue = true;
             }
         }
 
-        ~Discoverer()
+        ~Frame()
         {
             Dispose(false);
         }
@@ -344,33 +710,746 @@ namespace ngw
         #endregion
     }
 
-    public static class NativeTypes
+    /// <summary>
+    /// Wrapper of the C++ PlayerGroup class. Plays its members in lock step
+    /// on one shared clock. Members are kept referenced while in the group.
+    /// </summary>
+    public class PlayerGroup : IDisposable
     {
-        #region C Callback Types
+        #region Private Members
 
-        public delegate void ErrorDelegate([MarshalAs(UnmanagedType.LPStr)] string message, IntPtr player);
-        public delegate void FrameDelegate(IntPtr buffer, uint size, IntPtr player);
+        IntPtr              mNativeGroup    = IntPtr.Zero;
+        List<Player>        mPlayers        = new List<Player>();
+
+        #endregion
+
+        #region PlayerGroup API
+
+        public PlayerGroup()
+        {
+            mNativeGroup = NativeMethods.ngw_player_group_make();
+        }
+
+        public bool add(Player player)
+        {
+            if (!NativeMethods.ngw_player_group_add(mNativeGroup, player.nativePlayer))
+                return false;
+
+            mPlayers.Add(player);
+            return true;
+        }
+
+        public void remove(Player player)
+        {
+            NativeMethods.ngw_player_group_remove(mNativeGroup, player.nativePlayer);
+            mPlayers.Remove(player);
+        }
+
+        public uint size
+        {
+            get { return NativeMethods.ngw_player_group_get_size(mNativeGroup); }
+        }
+
+        public void play()
+        {
+            NativeMethods.ngw_player_group_play(mNativeGroup);
+        }
+
+        public void pause()
+        {
+            NativeMethods.ngw_player_group_pause(mNativeGroup);
+        }
+
+        public double time
+        {
+            get { return NativeMethods.ngw_player_group_get_time(mNativeGroup); }
+            set { NativeMethods.ngw_player_group_set_time(mNativeGroup, value); }
+        }
+
+        // Seconds a member is ahead (positive) or behind (negative) of the position the group clock expects
+        public double getDrift(Player player)
+        {
+            return NativeMethods.ngw_player_group_get_drift(mNativeGroup, player.nativePlayer);
+        }
+
+        #endregion
+
+        #region IDisposable Support
+        bool mDisposedValue = false;
+
+        protected virtual void Dispose(bool disposing)
+        {
+            if (!mDisposedValue)
+            {
+                NativeMethods.ngw_player_group_free(mNativeGroup);
+                mNativeGroup = IntPtr.Zero;
+                mDisposedValue = true;
+
+                if (disposing)
+                {
+                    mPlayers.Clear();
+                }
+            }
+        }
+
+        ~PlayerGroup()
+        {
+            Dispose(false);
+        }
+
+        public void Dispose()
+        {
+            Dispose(true);
+            GC.SuppressFinalize(this);
+        }
+        #endregion
+    }
+
+    /// <summary>
+    /// Wrapper of the C++ PlayerManager class. Updates all of its players
+    /// with a single native call and reports a snapshot of each of them.
+    /// Players are kept referenced while managed.
+    /// </summary>
+    public class PlayerManager : IDisposable
+    {
+        #region Private Members
+
+        IntPtr              mNativeManager  = IntPtr.Zero;
+        List<Player>        mPlayers        = new List<Player>();
+        GCHandle            mProcessCallbackHandle;
+
+        // Called for every delivered frame, on a worker thread if there are workers. Frame is ONLY valid inside
+        public Action<Frame, Player> OnProcess;
+
+        #endregion
+
+        #region PlayerManager API
+
+        /// <summary>
+        /// "workers" is the number of threads OnProcess is called on (0 calls
+        /// it on the thread calling update).
+        /// </summary>
+        public PlayerManager(uint workers = 0)
+        {
+            mNativeManager = NativeMethods.ngw_manager_make(workers);
+
+            if (mNativeManager != IntPtr.Zero)
+            {
+                var process_delegate = new NativeTypes.ProcessDelegate((frame, player, manager) =>
+                {
+                    if (OnProcess == null)
+                        return;
+
+                    Player owner = mPlayers.Find(p => p.nativePlayer == player);
+                    using (Frame lease = new Frame(frame, false))
+                    {
+                        OnProcess(lease, owner);
+                    }
+                });
+
+                mProcessCallbackHandle = GCHandle.Alloc(process_delegate, GCHandleType.Pinned);
+                NativeMethods.ngw_manager_set_process_callback(mNativeManager, process_delegate);
+            }
+        }
+
+        public bool add(Player player)
+        {
+            if (!NativeMethods.ngw_manager_add(mNativeManager, player.nativePlayer))
+                return false;
+
+            mPlayers.Add(player);
+            return true;
+        }
+
+        public void remove(Player player)
+        {
+            NativeMethods.ngw_manager_remove(mNativeManager, player.nativePlayer);
+            mPlayers.Remove(player);
+        }
+
+        public uint size
+        {
+            get { return NativeMethods.ngw_manager_get_size(mNativeManager); }
+        }
+
+        /// <summary>
+        /// Updates all players. Fills "states" (in order of addition, can be
+        /// null) and returns number of snapshots filled.
+        /// </summary>
+        public uint update(NativeTypes.PlayerState[] states)
+        {
+            return NativeMethods.ngw_manager_update(mNativeManager, states, states != null ? (uint)states.Length : 0);
+        }
+
+        /// <summary>
+        /// Same as update(states), presenting frames due by the next vblank.
+        /// See Player.update(vblank)
+        /// </summary>
+        public uint update(NativeTypes.PlayerState[] states, long vblank)
+        {
+            return NativeMethods.ngw_manager_update_vblank(mNativeManager, states, states != null ? (uint)states.Length : 0, vblank);
+        }
+
+        #endregion
+
+        #region IDisposable Support
+        bool mDisposedValue = false;
+
+        protected virtual void Dispose(bool disposing)
+        {
+            if (!mDisposedValue)
+            {
+                NativeMethods.ngw_manager_free(mNativeManager);
+                mNativeManager = IntPtr.Zero;
+                mDisposedValue = true;
+
+                if (disposing)
+                {
+                    mPlayers.Clear();
+
+                    if (mProcessCallbackHandle.IsAllocated)
+                        mProcessCallbackHandle.Free();
+                }
+            }
+        }
+
+        ~PlayerManager()
+        {
+            Dispose(false);
+        }
+
+        public void Dispose()
+        {
+            Dispose(true);
+            GC.SuppressFinalize(this);
+        }
+        #endregion
+    }
+
+    /// <summary>
+    /// Wrapper GStreamer discoverer class, provides the same functionality
+    /// of its C++ counterpart. Use of this class is optional. You can
+    /// directly use DllImported methods inside NativeMethods class.
+    /// </summary>
+    public class Discoverer : IDisposable
+    {
+        #region Private Members
+
+        IntPtr mNativeDiscoverer = IntPtr.Zero;
+        bool   mOwned            = true;
+
+        #endregion
+
+        #region Discoverer API
+
+        public Discoverer()
+        {
+            mNativeDiscoverer = NativeMethods.ngw_discoverer_make();
+        }
+
+        /// <summary>
+        /// Wraps a discoverer owned by native code (DiscovererBatch results)
+        /// </summary>
+        internal Discoverer(IntPtr native_discoverer, bool owned)
+        {
+            mNativeDiscoverer = native_discoverer;
+            mOwned = owned;
+        }
+
+        public bool open(string path)
+        {
+            return NativeMethods.ngw_discoverer_open(mNativeDiscoverer, path);
+        }
+
+        public int width
+        {
+            get { return NativeMethods.ngw_discoverer_get_width(mNativeDiscoverer); }
+        }
+
+        public int height
+        {
+            get { return NativeMethods.ngw_discoverer_get_height(mNativeDiscoverer); }
+        }
+
+        public bool seekable
+        {
+            get { return NativeMethods.ngw_discoverer_get_seekable(mNativeDiscoverer); }
+        }
+
+        public bool hasAudio
+        {
+            get { return NativeMethods.ngw_discoverer_get_has_audio(mNativeDiscoverer); }
+        }
+
+        public bool hasVideo
+        {
+            get { return NativeMethods.ngw_discoverer_get_has_video(mNativeDiscoverer); }
+        }
+
+        public float frameRate
+        {
+            get { return NativeMethods.ngw_discoverer_get_frame_rate(mNativeDiscoverer); }
+        }
+
+        public double duration
+        {
+            get { return NativeMethods.ngw_discoverer_get_duration(mNativeDiscoverer); }
+        }
+
+        public uint sampleRate
+        {
+            get { return NativeMethods.ngw_discoverer_get_sample_rate(mNativeDiscoverer); }
+        }
+
+        public uint bitRate
+        {
+            get { return NativeMethods.ngw_discoverer_get_bit_rate(mNativeDiscoverer); }
+        }
+
+        public string uri
+        {
+            get { return Marshal.PtrToStringAnsi(NativeMethods.ngw_discoverer_get_uri(mNativeDiscoverer)); }
+        }
+
+        #endregion
+
+        #region IDisposable Support
+        bool mDisposedValue = false;
+
+        protected virtual void Dispose(bool disposing)
+        {
+            if (!mDisposedValue)
+            {
+                if (disposing)
+                {
+                    // no managed resources to be freed.
+                }
+
+                if (mOwned)
+                    NativeMethods.ngw_discoverer_free(mNativeDiscoverer);
+
+                mNativeDiscoverer = IntPtr.Zero;
+                mDisposedValue = true;
+            }
+        }
+
+        ~Discoverer()
+        {
+            Dispose(false);
+        }
+
+        public void Dispose()
+        {
+            Dispose(true);
+            GC.SuppressFinalize(this);
+        }
+        #endregion
+    }
+
+    /// <summary>
+    /// Wrapper of the C++ DiscovererBatch class. Discovers many media files
+    /// in parallel and raises OnDiscovered once per added media, from within
+    /// update() or wait(). Discoverer passed to OnDiscovered is only valid
+    /// inside the event; copy whatever is needed out of it.
+    /// </summary>
+    public class DiscovererBatch : IDisposable
+    {
+        #region Private Members
+
+        IntPtr                              mNativeBatch    = IntPtr.Zero;
+        GCHandle                            mDiscoveredCallbackHandle;
+
+        public Action<Discoverer, bool>     OnDiscovered;
+
+        #endregion
+
+        #region DiscovererBatch API
+
+        /// <summary>
+        /// "workers" is the maximum number of media probed at the same time
+        /// (0 means number of processors).
+        /// </summary>
+        public DiscovererBatch(uint workers = 0)
+        {
+            mNativeBatch = NativeMethods.ngw_discoverer_batch_make(workers);
+
+            if (mNativeBatch != IntPtr.Zero)
+            {
+                var discovered_delegate = new NativeTypes.DiscoveredDelegate((discoverer, success, batch) =>
+                {
+                    if (OnDiscovered != null)
+                    {
+                        using (var view = new Discoverer(discoverer, false))
+                            OnDiscovered(view, success);
+                    }
+                });
+
+                mDiscoveredCallbackHandle = GCHandle.Alloc(discovered_delegate, GCHandleType.Pinned);
+                NativeMethods.ngw_discoverer_batch_set_discovered_callback(mNativeBatch, discovered_delegate);
+            }
+        }
+
+        public bool add(string path)
+        {
+            return NativeMethods.ngw_discoverer_batch_add(mNativeBatch, path);
+        }
+
+        public void update()
+        {
+            NativeMethods.ngw_discoverer_batch_update(mNativeBatch);
+        }
+
+        public void wait()
+        {
+            NativeMethods.ngw_discoverer_batch_wait(mNativeBatch);
+        }
+
+        public void cancel()
+        {
+            NativeMethods.ngw_discoverer_batch_cancel(mNativeBatch);
+        }
+
+        public uint pending
+        {
+            get { return NativeMethods.ngw_discoverer_batch_get_pending(mNativeBatch); }
+        }
+
+        public bool done
+        {
+            get { return NativeMethods.ngw_discoverer_batch_is_done(mNativeBatch); }
+        }
+
+        #endregion
+
+        #region IDisposable Support
+        bool mDisposedValue = false;
+
+        protected virtual void Dispose(bool disposing)
+        {
+            if (!mDisposedValue)
+            {
+                NativeMethods.ngw_discoverer_batch_free(mNativeBatch);
+                mNativeBatch = IntPtr.Zero;
+                mDisposedValue = true;
+
+                if (disposing)
+                {
+                    if (mDiscoveredCallbackHandle.IsAllocated)
+                        mDiscoveredCallbackHandle.Free();
+                }
+            }
+        }
+
+        ~DiscovererBatch()
+        {
+            Dispose(false);
+        }
+
+        public void Dispose()
+        {
+            Dispose(true);
+            GC.SuppressFinalize(this);
+        }
+        #endregion
+    }
+
+    /// <summary>
+    /// Wrapper of the C++ Thumbnailer class. Extracts frames of a video at
+    /// given times in parallel and raises OnThumbnail from within update()
+    /// or wait(). Frames passed to OnThumbnail are owned by the subscriber
+    /// and MUST be disposed.
+    /// </summary>
+    public class Thumbnailer : IDisposable
+    {
+        #region Private Members
+
+        IntPtr                              mNativeThumbnailer  = IntPtr.Zero;
+        GCHandle                            mThumbnailCallbackHandle;
+        GCHandle                            mErrorCallbackHandle;
+
+        public Action<double, Frame>        OnThumbnail;
+        public Action<string>               OnErrorReceived;
+
+        #endregion
+
+        #region Thumbnailer API
+
+        /// <summary>
+        /// "pipelines" is the maximum number of frames decoded at the same
+        /// time (0 means number of processors).
+        /// </summary>
+        public Thumbnailer(uint pipelines = 0)
+        {
+            mNativeThumbnailer = NativeMethods.ngw_thumbnailer_make(pipelines);
+
+            if (mNativeThumbnailer != IntPtr.Zero)
+            {
+                var thumbnail_delegate = new NativeTypes.ThumbnailDelegate((time, frame, thumbnailer) =>
+                {
+                    if (OnThumbnail != null)
+                        OnThumbnail(time, new Frame(frame));
+                    else
+                        NativeMethods.ngw_frame_release(frame);
+                });
+
+                var error_delegate = new NativeTypes.ThumbnailerErrorDelegate((msg, thumbnailer) =>
+                {
+                    if (OnErrorReceived != null)
+                        OnErrorReceived(msg);
+                });
+
+                mThumbnailCallbackHandle = GCHandle.Alloc(thumbnail_delegate, GCHandleType.Pinned);
+                mErrorCallbackHandle = GCHandle.Alloc(error_delegate, GCHandleType.Pinned);
+
+                NativeMethods.ngw_thumbnailer_set_thumbnail_callback(mNativeThumbnailer, thumbnail_delegate);
+                NativeMethods.ngw_thumbnailer_set_error_callback(mNativeThumbnailer, error_delegate);
+            }
+        }
+
+        public bool open(string path, int width, int height)
+        {
+            return NativeMethods.ngw_thumbnailer_open(mNativeThumbnailer, path, width, height);
+        }
+
+        public bool open(string path, int width, int height, string format)
+        {
+            return NativeMethods.ngw_thumbnailer_open_format(mNativeThumbnailer, path, width, height, format);
+        }
+
+        public void close()
+        {
+            NativeMethods.ngw_thumbnailer_close(mNativeThumbnailer);
+        }
+
+        public bool extract(double time)
+        {
+            return NativeMethods.ngw_thumbnailer_extract(mNativeThumbnailer, time);
+        }
+
+        public bool extractStrip(uint count)
+        {
+            return NativeMethods.ngw_thumbnailer_extract_strip(mNativeThumbnailer, count);
+        }
+
+        public void update()
+        {
+            NativeMethods.ngw_thumbnailer_update(mNativeThumbnailer);
+        }
+
+        public void wait()
+        {
+            NativeMethods.ngw_thumbnailer_wait(mNativeThumbnailer);
+        }
+
+        public void cancel()
+        {
+            NativeMethods.ngw_thumbnailer_cancel(mNativeThumbnailer);
+        }
+
+        public uint pending
+        {
+            get { return NativeMethods.ngw_thumbnailer_get_pending(mNativeThumbnailer); }
+        }
+
+        public bool done
+        {
+            get { return NativeMethods.ngw_thumbnailer_is_done(mNativeThumbnailer); }
+        }
+
+        public int width
+        {
+            get { return NativeMethods.ngw_thumbnailer_get_width(mNativeThumbnailer); }
+        }
+
+        public int height
+        {
+            get { return NativeMethods.ngw_thumbnailer_get_height(mNativeThumbnailer); }
+        }
+
+        #endregion
+
+        #region IDisposable Support
+        bool mDisposedValue = false;
+
+        protected virtual void Dispose(bool disposing)
+        {
+            if (!mDisposedValue)
+            {
+                NativeMethods.ngw_thumbnailer_free(mNativeThumbnailer);
+                mNativeThumbnailer = IntPtr.Zero;
+                mDisposedValue = true;
+
+                if (disposing)
+                {
+                    if (mThumbnailCallbackHandle.IsAllocated)
+                        mThumbnailCallbackHandle.Free();
+
+                    if (mErrorCallbackHandle.IsAllocated)
+                        mErrorCallbackHandle.Free();
+                }
+            }
+        }
+
+        ~Thumbnailer()
+        {
+            Dispose(false);
+        }
+
+        public void Dispose()
+        {
+            Dispose(true);
+            GC.SuppressFinalize(this);
+        }
+        #endregion
+    }
+
+    public static class NativeTypes
+    {
+        #region C Callback Types
+
+        public delegate void ErrorDelegate([MarshalAs(UnmanagedType.LPStr)] string message, IntPtr player);
+        public delegate void FrameDelegate(IntPtr buffer, uint size, IntPtr player);
         public delegate void StateDelegate(State state, IntPtr player);
         public delegate void StreamEndDelegate(IntPtr player);
+        public delegate void SeekedDelegate(double latency, IntPtr player);
+        public delegate void FrameInfoDelegate(IntPtr info, IntPtr buffer, uint size, IntPtr player);
+        public delegate void ProcessDelegate(IntPtr frame, IntPtr player, IntPtr manager);
+        public delegate void OpenedDelegate([MarshalAs(UnmanagedType.Bool)] bool success, IntPtr player);
+        public delegate void TrackChangedDelegate([MarshalAs(UnmanagedType.LPStr)] string uri, IntPtr player);
+        public delegate void ThumbnailDelegate(double time, IntPtr frame, IntPtr thumbnailer);
+        public delegate void ThumbnailerErrorDelegate([MarshalAs(UnmanagedType.LPStr)] string message, IntPtr thumbnailer);
+        public delegate void DiscoveredDelegate(IntPtr discoverer, [MarshalAs(UnmanagedType.Bool)] bool success, IntPtr batch);
 
         #endregion
 
-        #region C Data Types
+        #region C Data Types
+
+        public enum State
+        {
+            Pending,
+            Null,
+            Ready,
+            Paused,
+            Playing
+        }
+
+        public enum Buffer
+        {
+            BytePointer,
+            OpenGlTexture,
+            CallbackFunction,
+            FrameLease,
+            TripleBuffer
+        }
+
+        [StructLayout(LayoutKind.Sequential)]
+        public struct FrameLayout
+        {
+            public IntPtr format;
+            public int width;
+            public int height;
+            public uint planes;
+            [MarshalAs(UnmanagedType.ByValArray, SizeConst = 4)]
+            public IntPtr[] data;
+            [MarshalAs(UnmanagedType.ByValArray, SizeConst = 4)]
+            public UIntPtr[] offset;
+            [MarshalAs(UnmanagedType.ByValArray, SizeConst = 4)]
+            public int[] stride;
+
+            public string formatName
+            {
+                get { return Marshal.PtrToStringAnsi(format); }
+            }
+        }
+
+        [StructLayout(LayoutKind.Sequential)]
+        public struct PlayerState
+        {
+            public IntPtr player;
+            public State state;
+            public double time;
+            public double duration;
+            public int width;
+            public int height;
+            public ulong sequence;
+        }
+
+        [StructLayout(LayoutKind.Sequential)]
+        public struct FrameInfo
+        {
+            public FrameLayout layout;
+            public ulong pts;
+            public ulong duration;
+            public ulong runningTime;
+            public long presentTime;
+            public long arrivalTime;
+            public ulong sequence;
+        }
+
+        public enum FrameQueue
+        {
+            Latest,
+            Fifo,
+            Block
+        }
+
+        public enum FrameDrop
+        {
+            Queue,
+            Late,
+            Map,
+            Copy
+        }
+
+        [StructLayout(LayoutKind.Sequential)]
+        public struct PlayerStats
+        {
+            public ulong framesReceived;
+            public ulong framesDelivered;
+            [MarshalAs(UnmanagedType.ByValArray, SizeConst = 4)]
+            public ulong[] framesDropped;
+            public double averageLatency;
+            public double maxLatency;
+            public double averageFrameTime;
+            public double maxFrameTime;
+            public ulong seeks;
+            public double averageSeekLatency;
+            public double maxSeekLatency;
+            public ulong busMessages;
+            public ulong bytesCopied;
+
+            public ulong getFramesDropped(FrameDrop reason)
+            {
+                return framesDropped[(int)reason];
+            }
+        }
+
+        public enum ScaleMethod
+        {
+            Default,
+            Preview,
+            Nearest,
+            Bilinear,
+            Cubic,
+            Lanczos
+        }
 
-        public enum State
+        public enum DitherMethod
         {
-            Pending,
-            Null,
-            Ready,
-            Paused,
-            Playing
+            Default,
+            None,
+            Verterr,
+            FloydSteinberg,
+            SierraLite,
+            Bayer
         }
 
-        public enum Buffer
+        [StructLayout(LayoutKind.Sequential)]
+        public struct ConvertOptions
         {
-            BytePointer,
-            OpenGlTexture,
-            CallbackFunction
+            public uint threads;
+            public ScaleMethod scale;
+            public DitherMethod dither;
         }
 
         public enum Boolean
@@ -390,6 +1469,39 @@ namespace ngw
         [DllImport("ngw")]
         public static extern void ngw_add_binary_path([MarshalAs(UnmanagedType.LPStr)] string path);
 
+        [DllImport("ngw")]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        public static extern bool ngw_set_element_rank([MarshalAs(UnmanagedType.LPStr)] string factory, uint rank);
+
+        [DllImport("ngw")]
+        public static extern void ngw_set_decoder_thread_budget(uint threads, uint decoders);
+
+        [DllImport("ngw")]
+        public static extern void ngw_set_discovery_cache_enabled([MarshalAs(UnmanagedType.Bool)] bool on);
+
+        [DllImport("ngw")]
+        public static extern void ngw_set_discovery_cache_file([MarshalAs(UnmanagedType.LPStr)] string path);
+
+        [DllImport("ngw")]
+        public static extern void ngw_clear_discovery_cache();
+
+        [DllImport("ngw")]
+        public static extern void ngw_set_trace_enabled([MarshalAs(UnmanagedType.Bool)] bool on);
+
+        [DllImport("ngw")]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        public static extern bool ngw_get_trace_enabled();
+
+        [DllImport("ngw")]
+        public static extern void ngw_set_trace_gst_latency([MarshalAs(UnmanagedType.Bool)] bool on);
+
+        [DllImport("ngw")]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        public static extern bool ngw_dump_trace([MarshalAs(UnmanagedType.LPStr)] string path);
+
+        [DllImport("ngw")]
+        public static extern void ngw_clear_trace();
+
         [DllImport("ngw")]
         public static extern IntPtr ngw_player_make();
 
@@ -412,6 +1524,17 @@ namespace ngw
         [return: MarshalAs(UnmanagedType.Bool)]
         public static extern bool ngw_player_open(IntPtr player, [MarshalAs(UnmanagedType.LPStr)] string path);
 
+        [DllImport("ngw")]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        public static extern bool ngw_player_open_async(IntPtr player, [MarshalAs(UnmanagedType.LPStr)] string path);
+
+        [DllImport("ngw")]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        public static extern bool ngw_player_open_async_resize_format(IntPtr player, [MarshalAs(UnmanagedType.LPStr)] string path, int width, int height, [MarshalAs(UnmanagedType.LPStr)] string fmt);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_set_opened_callback(IntPtr player, NativeTypes.OpenedDelegate cb);
+
         [DllImport("ngw")]
         public static extern void ngw_player_close(IntPtr player);
 
@@ -436,6 +1559,15 @@ namespace ngw
         [DllImport("ngw")]
         public static extern void ngw_player_update(IntPtr player);
 
+        [DllImport("ngw")]
+        public static extern void ngw_player_update_vblank(IntPtr player, long vblank);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_set_frame_lead(IntPtr player, double seconds);
+
+        [DllImport("ngw")]
+        public static extern double ngw_player_get_frame_lead(IntPtr player);
+
         [DllImport("ngw")]
         public static extern double ngw_player_get_duration(IntPtr player);
 
@@ -452,6 +1584,19 @@ namespace ngw
         [DllImport("ngw")]
         public static extern double ngw_player_get_time(IntPtr player);
 
+        [DllImport("ngw")]
+        public static extern void ngw_player_set_scrubbing(IntPtr player, [MarshalAs(UnmanagedType.Bool)] bool on);
+
+        [DllImport("ngw")]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        public static extern bool ngw_player_get_scrubbing(IntPtr player);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_set_seeked_callback(IntPtr player, NativeTypes.SeekedDelegate cb);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_set_frame_info_callback(IntPtr player, NativeTypes.FrameInfoDelegate cb);
+
         [DllImport("ngw")]
         public static extern void ngw_player_set_volume(IntPtr player, double vol);
 
@@ -483,6 +1628,24 @@ namespace ngw
         [DllImport("ngw")]
         public static extern void ngw_player_set_frame_buffer(IntPtr player, IntPtr buffer, NativeTypes.Buffer type);
 
+        [DllImport("ngw")]
+        public static extern void ngw_player_set_frame_buffer_size(IntPtr player, UIntPtr size);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_set_frame_pool(IntPtr player, IntPtr[] buffers, uint count, UIntPtr size);
+
+        [DllImport("ngw")]
+        public static extern int ngw_player_get_frame_pool_index(IntPtr player);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_set_triple_buffer(IntPtr player, IntPtr[] buffers, UIntPtr size);
+
+        [DllImport("ngw")]
+        public static extern IntPtr ngw_player_acquire_latest(IntPtr player, out ulong sequence);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_release_latest(IntPtr player);
+
         [DllImport("ngw")]
         public static extern void ngw_player_set_frame_dirty_flag(IntPtr player, ref NativeTypes.Boolean flag);
 
@@ -498,6 +1661,156 @@ namespace ngw
         [DllImport("ngw")]
         public static extern double ngw_player_get_rate(IntPtr player);
 
+        [DllImport("ngw")]
+        public static extern void ngw_player_set_frame_queue(IntPtr player, NativeTypes.FrameQueue policy, uint depth);
+
+        [DllImport("ngw")]
+        public static extern NativeTypes.FrameQueue ngw_player_get_frame_queue_policy(IntPtr player);
+
+        [DllImport("ngw")]
+        public static extern uint ngw_player_get_frame_queue_depth(IntPtr player);
+
+        [DllImport("ngw")]
+        public static extern uint ngw_player_get_dropped_frames(IntPtr player, NativeTypes.FrameQueue policy);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_get_stats(IntPtr player, out NativeTypes.PlayerStats stats);
+
+        [DllImport("ngw")]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        public static extern bool ngw_player_enqueue(IntPtr player, [MarshalAs(UnmanagedType.LPStr)] string path);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_clear_queue(IntPtr player);
+
+        [DllImport("ngw")]
+        public static extern uint ngw_player_get_queue_length(IntPtr player);
+
+        [DllImport("ngw")]
+        public static extern IntPtr ngw_player_get_uri(IntPtr player);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_set_track_changed_callback(IntPtr player, NativeTypes.TrackChangedDelegate cb);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_set_reuse_pipeline(IntPtr player, [MarshalAs(UnmanagedType.Bool)] bool on);
+
+        [DllImport("ngw")]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        public static extern bool ngw_player_get_reuse_pipeline(IntPtr player);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_set_bus_thread(IntPtr player, [MarshalAs(UnmanagedType.Bool)] bool on);
+
+        [DllImport("ngw")]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        public static extern bool ngw_player_get_bus_thread(IntPtr player);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_set_sync(IntPtr player, [MarshalAs(UnmanagedType.Bool)] bool on);
+
+        [DllImport("ngw")]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        public static extern bool ngw_player_get_sync(IntPtr player);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_set_padded_frames(IntPtr player, [MarshalAs(UnmanagedType.Bool)] bool on);
+
+        [DllImport("ngw")]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        public static extern bool ngw_player_get_padded_frames(IntPtr player);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_set_decoder_property(IntPtr player, [MarshalAs(UnmanagedType.LPStr)] string name, [MarshalAs(UnmanagedType.LPStr)] string value);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_set_decoder_threads(IntPtr player, uint threads);
+
+        [DllImport("ngw")]
+        public static extern uint ngw_player_get_decoder_threads(IntPtr player);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_set_convert_options(IntPtr player, ref NativeTypes.ConvertOptions options);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_get_convert_options(IntPtr player, out NativeTypes.ConvertOptions options);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_set_audio_tap(IntPtr player, [MarshalAs(UnmanagedType.LPStr)] string format, int rate, int channels, uint latency);
+
+        [DllImport("ngw")]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        public static extern bool ngw_player_get_audio_tap(IntPtr player);
+
+        [DllImport("ngw")]
+        public static extern UIntPtr ngw_player_read_audio(IntPtr player, IntPtr dst, UIntPtr size);
+
+        [DllImport("ngw")]
+        public static extern UIntPtr ngw_player_read_audio(IntPtr player, [Out] float[] dst, UIntPtr size);
+
+        [DllImport("ngw")]
+        public static extern UIntPtr ngw_player_get_audio_available(IntPtr player);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_set_crop(IntPtr player, int left, int top, int right, int bottom);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_get_crop(IntPtr player, out int left, out int top, out int right, out int bottom);
+
+        [DllImport("ngw")]
+        public static extern double ngw_player_get_upload_time(IntPtr player);
+
+        [DllImport("ngw")]
+        public static extern double ngw_player_get_upload_copy_time(IntPtr player);
+
+        [DllImport("ngw")]
+        public static extern IntPtr ngw_player_lease_frame(IntPtr player);
+
+        [DllImport("ngw")]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        public static extern bool ngw_player_get_frame_layout(IntPtr player, out NativeTypes.FrameLayout layout);
+
+        [DllImport("ngw")]
+        public static extern IntPtr ngw_frame_get_data(IntPtr frame);
+
+        [DllImport("ngw")]
+        public static extern uint ngw_frame_get_size(IntPtr frame);
+
+        [DllImport("ngw")]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        public static extern bool ngw_frame_get_layout(IntPtr frame, out NativeTypes.FrameLayout layout);
+
+        [DllImport("ngw")]
+        public static extern void ngw_frame_get_info(IntPtr frame, out NativeTypes.FrameInfo info);
+
+        [DllImport("ngw")]
+        public static extern void ngw_frame_release(IntPtr frame);
+
+        [DllImport("ngw")]
+        public static extern IntPtr ngw_manager_make(uint workers);
+
+        [DllImport("ngw")]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        public static extern bool ngw_manager_add(IntPtr manager, IntPtr player);
+
+        [DllImport("ngw")]
+        public static extern void ngw_manager_remove(IntPtr manager, IntPtr player);
+
+        [DllImport("ngw")]
+        public static extern uint ngw_manager_get_size(IntPtr manager);
+
+        [DllImport("ngw")]
+        public static extern uint ngw_manager_update(IntPtr manager, [In, Out] NativeTypes.PlayerState[] states, uint count);
+
+        [DllImport("ngw")]
+        public static extern uint ngw_manager_update_vblank(IntPtr manager, [In, Out] NativeTypes.PlayerState[] states, uint count, long vblank);
+
+        [DllImport("ngw")]
+        public static extern void ngw_manager_free(IntPtr manager);
+
+        [DllImport("ngw")]
+        public static extern void ngw_manager_set_process_callback(IntPtr manager, NativeTypes.ProcessDelegate cb);
+
         [DllImport("ngw")]
         public static extern IntPtr ngw_discoverer_make();
 
@@ -541,9 +1854,125 @@ namespace ngw
         [DllImport("ngw")]
         public static extern IntPtr ngw_discoverer_get_uri(IntPtr discoverer);
 
+        [DllImport("ngw")]
+        public static extern IntPtr ngw_discoverer_batch_make(uint workers);
+
+        [DllImport("ngw")]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        public static extern bool ngw_discoverer_batch_add(IntPtr batch, [MarshalAs(UnmanagedType.LPStr)] string path);
+
+        [DllImport("ngw")]
+        public static extern void ngw_discoverer_batch_update(IntPtr batch);
+
+        [DllImport("ngw")]
+        public static extern void ngw_discoverer_batch_wait(IntPtr batch);
+
+        [DllImport("ngw")]
+        public static extern void ngw_discoverer_batch_cancel(IntPtr batch);
+
+        [DllImport("ngw")]
+        public static extern uint ngw_discoverer_batch_get_pending(IntPtr batch);
+
+        [DllImport("ngw")]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        public static extern bool ngw_discoverer_batch_is_done(IntPtr batch);
+
+        [DllImport("ngw")]
+        public static extern void ngw_discoverer_batch_set_discovered_callback(IntPtr batch, NativeTypes.DiscoveredDelegate cb);
+
+        [DllImport("ngw")]
+        public static extern void ngw_discoverer_batch_free(IntPtr batch);
+
+        [DllImport("ngw")]
+        public static extern IntPtr ngw_player_group_make();
+
+        [DllImport("ngw")]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        public static extern bool ngw_player_group_add(IntPtr group, IntPtr player);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_group_remove(IntPtr group, IntPtr player);
+
+        [DllImport("ngw")]
+        public static extern uint ngw_player_group_get_size(IntPtr group);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_group_play(IntPtr group);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_group_pause(IntPtr group);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_group_set_time(IntPtr group, double time);
+
+        [DllImport("ngw")]
+        public static extern double ngw_player_group_get_time(IntPtr group);
+
+        [DllImport("ngw")]
+        public static extern double ngw_player_group_get_drift(IntPtr group, IntPtr player);
+
+        [DllImport("ngw")]
+        public static extern void ngw_player_group_free(IntPtr group);
+
+        [DllImport("ngw")]
+        public static extern IntPtr ngw_thumbnailer_make(uint pipelines);
+
+        [DllImport("ngw")]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        public static extern bool ngw_thumbnailer_open(IntPtr thumbnailer, [MarshalAs(UnmanagedType.LPStr)] string path, int width, int height);
+
+        [DllImport("ngw")]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        public static extern bool ngw_thumbnailer_open_format(IntPtr thumbnailer, [MarshalAs(UnmanagedType.LPStr)] string path, int width, int height, [MarshalAs(UnmanagedType.LPStr)] string fmt);
+
+        [DllImport("ngw")]
+        public static extern void ngw_thumbnailer_close(IntPtr thumbnailer);
+
+        [DllImport("ngw")]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        public static extern bool ngw_thumbnailer_extract(IntPtr thumbnailer, double time);
+
+        [DllImport("ngw")]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        public static extern bool ngw_thumbnailer_extract_strip(IntPtr thumbnailer, uint count);
+
+        [DllImport("ngw")]
+        public static extern void ngw_thumbnailer_update(IntPtr thumbnailer);
+
+        [DllImport("ngw")]
+        public static extern void ngw_thumbnailer_wait(IntPtr thumbnailer);
+
+        [DllImport("ngw")]
+        public static extern void ngw_thumbnailer_cancel(IntPtr thumbnailer);
+
+        [DllImport("ngw")]
+        public static extern uint ngw_thumbnailer_get_pending(IntPtr thumbnailer);
+
+        [DllImport("ngw")]
+        [return: MarshalAs(UnmanagedType.Bool)]
+        public static extern bool ngw_thumbnailer_is_done(IntPtr thumbnailer);
+
+        [DllImport("ngw")]
+        public static extern int ngw_thumbnailer_get_width(IntPtr thumbnailer);
+
+        [DllImport("ngw")]
+        public static extern int ngw_thumbnailer_get_height(IntPtr thumbnailer);
+
+        [DllImport("ngw")]
+        public static extern void ngw_thumbnailer_set_thumbnail_callback(IntPtr thumbnailer, NativeTypes.ThumbnailDelegate cb);
+
+        [DllImport("ngw")]
+        public static extern void ngw_thumbnailer_set_error_callback(IntPtr thumbnailer, NativeTypes.ThumbnailerErrorDelegate cb);
+
+        [DllImport("ngw")]
+        public static extern void ngw_thumbnailer_free(IntPtr thumbnailer);
+
         [DllImport("ngw")]
         public static extern IntPtr ngw_get_version();
 
+        [DllImport("ngw")]
+        public static extern long ngw_get_monotonic_time();
+
     } // class NativeMethods
 
 } // namespace ngw
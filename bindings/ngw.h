@@ -8,6 +8,8 @@
  */
 #pragma once
 
+#include <stddef.h>
+
 //! @cond
 // Compiler specific shared library symbol visibility
 #if defined(_WIN32) && defined(NGW_BUILD_DLL)
@@ -39,6 +41,16 @@ extern "C" {
 typedef struct      _Player     Player;
 //! subclass of ngw::Discoverer to stay typed in C bindings.
 typedef struct      _Discoverer Discoverer;
+//! subclass of ngw::DiscovererBatch which exposes its virtual method as a callback.
+typedef struct      _DiscovererBatch DiscovererBatch;
+//! subclass of ngw::Thumbnailer which exposes its virtual methods as callbacks.
+typedef struct      _Thumbnailer Thumbnailer;
+//! ngw::PlayerGroup, plays Player objects in lock step.
+typedef struct      _PlayerGroup PlayerGroup;
+//! subclass of ngw::PlayerManager which exposes its virtual method as a callback.
+typedef struct      _PlayerManager PlayerManager;
+//! subclass of ngw::Frame, a lease of a video frame valid until ngw_frame_release()
+typedef struct      _Frame      Frame;
 //! boolean type, identical to gboolean
 typedef int         NgwBool;
 //! State type, identical to GstState enum
@@ -46,29 +58,145 @@ typedef int         NgwState;
 //! buffer types, specific to shared library target
 typedef enum {
     NGW_BUFFER_BYTE_POINTER         = 0, //!< a typical unsigned char* pointer
-    NGW_BUFFER_OPENGL_TEXTURE       = 1, //!< an OpenGL texture name
+    NGW_BUFFER_OPENGL_TEXTURE       = 1, //!< an OpenGL texture name, uploaded through pixel buffers (GL 3.0+)
     NGW_BUFFER_CALLBACK_FUNCTION    = 2, //!< a C-style callback function
+    NGW_BUFFER_FRAME_LEASE          = 3, //!< no buffer, latest frame is kept for ngw_player_lease_frame()
+    NGW_BUFFER_TRIPLE_BUFFER        = 4, //!< three unsigned char* pointers rotated by ngw, see ngw_player_set_triple_buffer()
 } NgwBuffer;
+//! frame queue policies, identical to ngw::FrameQueuePolicy enum
+typedef enum {
+    NGW_FRAME_QUEUE_LATEST          = 0, //!< a newer frame replaces an unconsumed one
+    NGW_FRAME_QUEUE_FIFO            = 1, //!< new frames are dropped if queue is full
+    NGW_FRAME_QUEUE_BLOCK           = 2, //!< streaming thread waits if queue is full
+} NgwFrameQueue;
+//! frame drop reasons, identical to ngw::FrameDropReason enum
+typedef enum {
+    NGW_FRAME_DROP_QUEUE            = 0, //!< replaced or rejected by the frame queue, or skipped by update(vblank)
+    NGW_FRAME_DROP_LATE             = 1, //!< discarded for being late by QoS of the video sink or decoder
+    NGW_FRAME_DROP_MAP              = 2, //!< buffer of the frame could not be mapped for reading
+    NGW_FRAME_DROP_COPY             = 3, //!< frame did not fit the byte pointer or triple buffer it is copied into
+    NGW_FRAME_DROP_REASON_COUNT     = 4, //!< number of drop reasons
+} NgwFrameDrop;
+//! runtime counters of a player, mirrors ngw::PlayerStats. Counters only grow, times are in milliseconds
+typedef struct {
+    unsigned long long  frames_received;    //!< frames handed off by the video sink
+    unsigned long long  frames_delivered;   //!< frames passed to the frame buffer or callback
+    unsigned long long  frames_dropped[NGW_FRAME_DROP_REASON_COUNT]; //!< frames dropped, per NgwFrameDrop
+    double              average_latency;    //!< average time from hand off by the streaming thread to delivery
+    double              max_latency;        //!< longest time from hand off by the streaming thread to delivery
+    double              average_frame_time; //!< average time spent delivering a frame
+    double              max_frame_time;     //!< longest time spent delivering a frame
+    unsigned long long  seeks;              //!< seeks completed
+    double              average_seek_latency; //!< average time from ngw_player_set_time() to the seek completing
+    double              max_seek_latency;   //!< longest time from ngw_player_set_time() to the seek completing
+    unsigned long long  bus_messages;       //!< messages taken off the pipeline's bus
+    unsigned long long  bytes_copied;       //!< bytes of frame data copied into byte pointers and textures
+} NgwPlayerStats;
+//! resampling used when the video is resized, identical to ngw::ScaleMethod enum
+typedef enum {
+    NGW_SCALE_DEFAULT               = 0, //!< left to GStreamer (bilinear)
+    NGW_SCALE_PREVIEW               = 1, //!< fastest, nearest neighbour without chroma resampling or dithering by default
+    NGW_SCALE_NEAREST               = 2, //!< nearest neighbour
+    NGW_SCALE_BILINEAR              = 3, //!< bilinear
+    NGW_SCALE_CUBIC                 = 4, //!< Catmull-Rom cubic
+    NGW_SCALE_LANCZOS               = 5, //!< Lanczos, sharpest and slowest
+} NgwScaleMethod;
+//! dithering used when the video is converted to a format of lower depth, identical to ngw::DitherMethod enum
+typedef enum {
+    NGW_DITHER_DEFAULT              = 0, //!< left to GStreamer (bayer), or none with NGW_SCALE_PREVIEW
+    NGW_DITHER_NONE                 = 1, //!< no dithering, fastest
+    NGW_DITHER_VERTERR              = 2, //!< propagates rounding errors vertically
+    NGW_DITHER_FLOYD_STEINBERG      = 3, //!< Floyd-Steinberg error diffusion
+    NGW_DITHER_SIERRA_LITE          = 4, //!< Sierra Lite error diffusion
+    NGW_DITHER_BAYER                = 5, //!< ordered bayer matrix
+} NgwDitherMethod;
+//! set up of video conversion and scaling, mirrors ngw::ConvertOptions
+typedef struct {
+    unsigned            threads;            //!< threads of the converter and scaler, 0 keeps GStreamer's default (one)
+    NgwScaleMethod      scale;
+    NgwDitherMethod     dither;
+} NgwConvertOptions;
+//! maximum number of planes of a video frame, identical to ngw::FrameLayout::MAX_PLANES
+#define NGW_MAX_PLANES 4
+//! memory layout of a video frame, mirrors ngw::FrameLayout. Planar formats (I420, NV12) use several planes
+typedef struct {
+    const char*     format;                 //!< video format name ("BGRA", "I420", "NV12", etc.)
+    int             width;                  //!< width of the frame in pixels
+    int             height;                 //!< height of the frame in pixels
+    unsigned        planes;                 //!< number of planes in use
+    unsigned char*  data[NGW_MAX_PLANES];   //!< pointer to the first byte of each plane
+    size_t          offset[NGW_MAX_PLANES]; //!< offset of each plane from the start of the frame data in bytes
+    int             stride[NGW_MAX_PLANES]; //!< bytes per row of each plane
+} NgwFrameLayout;
+//! layout, timing and sequence of a video frame, mirrors ngw::FrameInfo. Stream times are in nanoseconds
+//! (-1 if unknown), monotonic times are in microseconds on the time base of g_get_monotonic_time()
+typedef struct {
+    NgwFrameLayout      layout;             //!< format, size and plane layout of the frame
+    unsigned long long  pts;                //!< presentation time stamp of the buffer
+    unsigned long long  duration;           //!< duration of the buffer
+    unsigned long long  running_time;       //!< pts mapped to the running time of the pipeline
+    long long           present_time;       //!< monotonic time the frame is due on screen, -1 if unknown
+    long long           arrival_time;       //!< monotonic time the frame was handed off by the streaming thread
+    unsigned long long  sequence;           //!< number of the frame since open, starting from 1
+} NgwFrameInfo;
+//! snapshot of a player, mirrors ngw::PlayerState. Filled in by ngw_manager_update()
+typedef struct {
+    const Player*       player;             //!< player this snapshot belongs to
+    NgwState            state;              //!< current state of the player
+    double              time;               //!< current position in seconds
+    double              duration;           //!< duration of the media in seconds
+    int                 width;              //!< width of the video, 0 if audio only
+    int                 height;             //!< height of the video, 0 if audio only
+    unsigned long long  sequence;           //!< sequence number of the frame delivered by this update, 0 if none
+} NgwPlayerState;
 
 //! Frame virtual callback. Instance of the Player is passed in.
 typedef void       (*NGW_FRAME_CALLBACK_TYPE)(unsigned char*, unsigned int, const Player*);
+//! Frame info virtual callback. Descriptor, video data, its size and instance of the Player are passed in.
+typedef void       (*NGW_FRAME_INFO_CALLBACK_TYPE)(const NgwFrameInfo*, unsigned char*, unsigned int, const Player*);
+//! Process virtual callback. Frame (ONLY valid inside the callback), its Player and instance of the manager are passed in.
+typedef void       (*NGW_PROCESS_CALLBACK_TYPE)(Frame*, const Player*, const PlayerManager*);
 //! Error virtual callback. Instance of the Player is passed in.
 typedef void       (*NGW_ERROR_CALLBACK_TYPE)(const char*, const Player*);
 //! State virtual callback. Instance of the Player is passed in.
 typedef void       (*NGW_STATE_CALLBACK_TYPE)(int, const Player*);
 //! Stream End virtual callback. Instance of the Player is passed in.
 typedef void       (*NGW_STREAM_END_CALLBACK_TYPE)(const Player*);
+//! Track Changed virtual callback. URI of the started media and instance of the Player are passed in.
+typedef void       (*NGW_TRACK_CHANGED_CALLBACK_TYPE)(const char*, const Player*);
+//! Opened virtual callback. Result of an async open and instance of the Player are passed in.
+typedef void       (*NGW_OPENED_CALLBACK_TYPE)(NgwBool, const Player*);
+//! Seeked virtual callback. Seek latency in seconds and instance of the Player are passed in.
+typedef void       (*NGW_SEEKED_CALLBACK_TYPE)(double, const Player*);
+//! Discovered virtual callback. Discoverer is ONLY valid inside the callback. Instance of the batch is passed in.
+typedef void       (*NGW_DISCOVERED_CALLBACK_TYPE)(const Discoverer*, NgwBool, const DiscovererBatch*);
+//! Thumbnail virtual callback. Requested time, a frame owned by the callee and instance of the Thumbnailer are passed in.
+typedef void       (*NGW_THUMBNAIL_CALLBACK_TYPE)(double, Frame*, const Thumbnailer*);
+//! Thumbnailer error virtual callback. Instance of the Thumbnailer is passed in.
+typedef void       (*NGW_THUMBNAILER_ERROR_CALLBACK_TYPE)(const char*, const Thumbnailer*);
 
 //! @cond NGW C api. For documentation please consult ngw.hpp
 NGWAPI const char* ngw_get_version(void);
 NGWAPI void        ngw_add_plugin_path(const char* path);
 NGWAPI void        ngw_add_binary_path(const char* path);
+NGWAPI NgwBool     ngw_set_element_rank(const char* factory, unsigned rank);
+NGWAPI void        ngw_set_decoder_thread_budget(unsigned threads, unsigned decoders);
+NGWAPI void        ngw_set_discovery_cache_enabled(NgwBool on);
+NGWAPI void        ngw_set_discovery_cache_file(const char* path);
+NGWAPI void        ngw_clear_discovery_cache(void);
+NGWAPI void        ngw_set_trace_enabled(NgwBool on);
+NGWAPI NgwBool     ngw_get_trace_enabled(void);
+NGWAPI void        ngw_set_trace_gst_latency(NgwBool on);
+NGWAPI NgwBool     ngw_dump_trace(const char* path);
+NGWAPI void        ngw_clear_trace(void);
 
 NGWAPI Player*     ngw_player_make(void);
 NGWAPI NgwBool     ngw_player_open(Player* player, const char* path);
 NGWAPI NgwBool     ngw_player_open_format(Player* player, const char* path, const char* fmt);
 NGWAPI NgwBool     ngw_player_open_resize(Player* player, const char* path, int width, int height);
 NGWAPI NgwBool     ngw_player_open_resize_format(Player* player, const char* path, int width, int height, const char* fmt);
+NGWAPI NgwBool     ngw_player_open_async(Player* player, const char* path);
+NGWAPI NgwBool     ngw_player_open_async_resize_format(Player* player, const char* path, int width, int height, const char* fmt);
 NGWAPI void        ngw_player_close(Player* player);
 NGWAPI void        ngw_player_set_state(Player* player, NgwState state);
 NGWAPI NgwState    ngw_player_get_state(Player* player);
@@ -77,9 +205,14 @@ NGWAPI void        ngw_player_play(Player* player);
 NGWAPI void        ngw_player_replay(Player* player);
 NGWAPI void        ngw_player_pause(Player* player);
 NGWAPI void        ngw_player_update(Player* player);
+NGWAPI void        ngw_player_update_vblank(Player* player, long long vblank);
+NGWAPI void        ngw_player_set_frame_lead(Player* player, double seconds);
+NGWAPI double      ngw_player_get_frame_lead(Player* player);
 NGWAPI double      ngw_player_get_duration(Player* player);
 NGWAPI void        ngw_player_set_time(Player* player, double time);
 NGWAPI double      ngw_player_get_time(Player* player);
+NGWAPI void        ngw_player_set_scrubbing(Player* player, NgwBool on);
+NGWAPI NgwBool     ngw_player_get_scrubbing(Player* player);
 NGWAPI void        ngw_player_set_volume(Player* player, double volume);
 NGWAPI double      ngw_player_get_volume(Player* player);
 NGWAPI void        ngw_player_set_mute(Player* player, NgwBool on);
@@ -90,7 +223,52 @@ NGWAPI int         ngw_player_get_width(Player* player);
 NGWAPI int         ngw_player_get_height(Player* player);
 NGWAPI void        ngw_player_set_rate(Player* player, double rate);
 NGWAPI double      ngw_player_get_rate(Player* player);
+NGWAPI void        ngw_player_set_frame_queue(Player* player, NgwFrameQueue policy, unsigned depth);
+NGWAPI NgwFrameQueue ngw_player_get_frame_queue_policy(Player* player);
+NGWAPI unsigned    ngw_player_get_frame_queue_depth(Player* player);
+NGWAPI unsigned    ngw_player_get_dropped_frames(Player* player, NgwFrameQueue policy);
+NGWAPI void        ngw_player_get_stats(Player* player, NgwPlayerStats* stats);
+NGWAPI void        ngw_player_set_reuse_pipeline(Player* player, NgwBool on);
+NGWAPI NgwBool     ngw_player_get_reuse_pipeline(Player* player);
+NGWAPI void        ngw_player_set_bus_thread(Player* player, NgwBool on);
+NGWAPI NgwBool     ngw_player_get_bus_thread(Player* player);
+NGWAPI void        ngw_player_set_sync(Player* player, NgwBool on);
+NGWAPI NgwBool     ngw_player_get_sync(Player* player);
+NGWAPI void        ngw_player_set_padded_frames(Player* player, NgwBool on);
+NGWAPI NgwBool     ngw_player_get_padded_frames(Player* player);
+NGWAPI void        ngw_player_set_decoder_property(Player* player, const char* name, const char* value);
+NGWAPI void        ngw_player_set_decoder_threads(Player* player, unsigned threads);
+NGWAPI unsigned    ngw_player_get_decoder_threads(Player* player);
+NGWAPI void        ngw_player_set_convert_options(Player* player, const NgwConvertOptions* options);
+NGWAPI void        ngw_player_get_convert_options(Player* player, NgwConvertOptions* options);
+NGWAPI void        ngw_player_set_audio_tap(Player* player, const char* format, int rate, int channels, unsigned latency);
+NGWAPI NgwBool     ngw_player_get_audio_tap(Player* player);
+NGWAPI size_t      ngw_player_read_audio(Player* player, void* dst, size_t size);
+NGWAPI size_t      ngw_player_get_audio_available(Player* player);
+NGWAPI void        ngw_player_set_crop(Player* player, int left, int top, int right, int bottom);
+NGWAPI void        ngw_player_get_crop(Player* player, int* left, int* top, int* right, int* bottom);
+NGWAPI NgwBool     ngw_player_enqueue(Player* player, const char* path);
+NGWAPI void        ngw_player_clear_queue(Player* player);
+NGWAPI unsigned    ngw_player_get_queue_length(Player* player);
+NGWAPI const char* ngw_player_get_uri(Player* player);
 NGWAPI void        ngw_player_free(Player* player);
+NGWAPI PlayerGroup* ngw_player_group_make(void);
+NGWAPI NgwBool     ngw_player_group_add(PlayerGroup* group, Player* player);
+NGWAPI void        ngw_player_group_remove(PlayerGroup* group, Player* player);
+NGWAPI unsigned    ngw_player_group_get_size(PlayerGroup* group);
+NGWAPI void        ngw_player_group_play(PlayerGroup* group);
+NGWAPI void        ngw_player_group_pause(PlayerGroup* group);
+NGWAPI void        ngw_player_group_set_time(PlayerGroup* group, double time);
+NGWAPI double      ngw_player_group_get_time(PlayerGroup* group);
+NGWAPI double      ngw_player_group_get_drift(PlayerGroup* group, Player* player);
+NGWAPI void        ngw_player_group_free(PlayerGroup* group);
+NGWAPI PlayerManager* ngw_manager_make(unsigned workers);
+NGWAPI NgwBool     ngw_manager_add(PlayerManager* manager, Player* player);
+NGWAPI void        ngw_manager_remove(PlayerManager* manager, Player* player);
+NGWAPI unsigned    ngw_manager_get_size(PlayerManager* manager);
+NGWAPI unsigned    ngw_manager_update(PlayerManager* manager, NgwPlayerState* states, unsigned count);
+NGWAPI unsigned    ngw_manager_update_vblank(PlayerManager* manager, NgwPlayerState* states, unsigned count, long long vblank);
+NGWAPI void        ngw_manager_free(PlayerManager* manager);
 NGWAPI Discoverer* ngw_discoverer_make(void);
 NGWAPI NgwBool     ngw_discoverer_open(Discoverer* discoverer, const char* path);
 NGWAPI const char* ngw_discoverer_get_uri(Discoverer* discoverer);
@@ -104,22 +282,122 @@ NGWAPI double      ngw_discoverer_get_duration(Discoverer* discoverer);
 NGWAPI unsigned    ngw_discoverer_get_sample_rate(Discoverer* discoverer);
 NGWAPI unsigned    ngw_discoverer_get_bit_rate(Discoverer* discoverer);
 NGWAPI void        ngw_discoverer_free(Discoverer* discoverer);
+NGWAPI DiscovererBatch* ngw_discoverer_batch_make(unsigned workers);
+NGWAPI NgwBool     ngw_discoverer_batch_add(DiscovererBatch* batch, const char* path);
+NGWAPI void        ngw_discoverer_batch_update(DiscovererBatch* batch);
+NGWAPI void        ngw_discoverer_batch_wait(DiscovererBatch* batch);
+NGWAPI void        ngw_discoverer_batch_cancel(DiscovererBatch* batch);
+NGWAPI unsigned    ngw_discoverer_batch_get_pending(DiscovererBatch* batch);
+NGWAPI NgwBool     ngw_discoverer_batch_is_done(DiscovererBatch* batch);
+NGWAPI void        ngw_discoverer_batch_free(DiscovererBatch* batch);
+NGWAPI Thumbnailer* ngw_thumbnailer_make(unsigned pipelines);
+NGWAPI NgwBool     ngw_thumbnailer_open(Thumbnailer* thumbnailer, const char* path, int width, int height);
+NGWAPI NgwBool     ngw_thumbnailer_open_format(Thumbnailer* thumbnailer, const char* path, int width, int height, const char* fmt);
+NGWAPI void        ngw_thumbnailer_close(Thumbnailer* thumbnailer);
+NGWAPI NgwBool     ngw_thumbnailer_extract(Thumbnailer* thumbnailer, double time);
+NGWAPI NgwBool     ngw_thumbnailer_extract_strip(Thumbnailer* thumbnailer, unsigned count);
+NGWAPI void        ngw_thumbnailer_update(Thumbnailer* thumbnailer);
+NGWAPI void        ngw_thumbnailer_wait(Thumbnailer* thumbnailer);
+NGWAPI void        ngw_thumbnailer_cancel(Thumbnailer* thumbnailer);
+NGWAPI unsigned    ngw_thumbnailer_get_pending(Thumbnailer* thumbnailer);
+NGWAPI NgwBool     ngw_thumbnailer_is_done(Thumbnailer* thumbnailer);
+NGWAPI int         ngw_thumbnailer_get_width(Thumbnailer* thumbnailer);
+NGWAPI int         ngw_thumbnailer_get_height(Thumbnailer* thumbnailer);
+NGWAPI void        ngw_thumbnailer_free(Thumbnailer* thumbnailer);
 //! @endcond
 
 //! sets a user data attached to a Player object. Useful to pass state into callback functions
 NGWAPI void        ngw_player_set_user_data(Player* player, void *data);
 //! gets a user data attached to a Player object. Useful to obtain a state from callback functions
 NGWAPI void*       ngw_player_get_user_data(Player* player);
-//! sets a frame buffer that receives video frames. "buffer" Could be of any of NgwBuffer types
+//! sets a frame buffer that receives video frames. "buffer" Could be of any of NgwBuffer types. For OpenGL textures,
+//! ngw_player_update() and ngw_player_free() must be called with the OpenGL context current. A frame shows up in
+//! the texture one ngw_player_update() after it is received since it is copied into a pixel buffer asynchronously
 NGWAPI void        ngw_player_set_frame_buffer(Player* player, void *buffer, NgwBuffer type);
+//! sets bytes a NGW_BUFFER_BYTE_POINTER frame buffer holds, frames that do not fit are dropped (NGW_FRAME_DROP_COPY).
+//! 0 (the default) trusts the buffer to hold a whole frame of the format and size the media was opened with
+NGWAPI void        ngw_player_set_frame_buffer_size(Player* player, size_t size);
+//! registers count caller owned buffers of size bytes each, frames are decoded straight into them from the next open. Buffers
+//! must stay valid until the player is closed, use at least frame queue depth + 6 of them. NULL or 0 count turns it off
+NGWAPI void        ngw_player_set_frame_pool(Player* player, unsigned char* const* buffers, unsigned count, size_t size);
+//! answers index of the frame pool buffer holding the latest frame, -1 if it was copied into the frame buffer instead.
+//! Valid with NGW_BUFFER_BYTE_POINTER type until the next ngw_player_update()
+NGWAPI int         ngw_player_get_frame_pool_index(Player* player);
+//! registers three buffers of size bytes each and switches to NGW_BUFFER_TRIPLE_BUFFER. ngw_player_update() copies
+//! every frame into one of them, ngw_player_acquire_latest() hands out the newest without tearing. Frames that do not
+//! fit (after a reopen at a larger size, etc.) are dropped as NGW_FRAME_DROP_COPY. NULL turns it off
+NGWAPI void        ngw_player_set_triple_buffer(Player* player, unsigned char* const* buffers, size_t size);
+//! answers the newest frame written by ngw_player_update() and its sequence number (NgwFrameInfo::sequence), NULL if there
+//! is none yet. The frame is never written to until ngw_player_release_latest(), acquiring again meanwhile answers the
+//! same frame. Safe to call from another thread than ngw_player_update(), but from one thread only
+NGWAPI const unsigned char* ngw_player_acquire_latest(Player* player, unsigned long long* sequence);
+//! gives the frame answered by ngw_player_acquire_latest() back, next acquire may answer a newer frame
+NGWAPI void        ngw_player_release_latest(Player* player);
 //! sets pointer to a boolean flag which is set to true whenever a frame is ready. Always false if buffer is OpenGL texture
 NGWAPI void        ngw_player_set_frame_dirty_flag(Player* player, NgwBool *flag);
+//! answers monotonic time in micro seconds, identical to g_get_monotonic_time(). Time base of vblank passed
+//! to ngw_player_update_vblank() and of monotonic times in NgwFrameInfo
+NGWAPI long long   ngw_get_monotonic_time(void);
 //! sets a callback function to be called on errors (propagated both by GStreamer and NGW)
 NGWAPI void        ngw_player_set_error_callback(Player* player, NGW_ERROR_CALLBACK_TYPE cb);
+//! sets a callback function to be called from ngw_player_update() per frame, after the frame buffer is
+//! filled. Works with every NgwBuffer type. Equivalent to onFrameInfo() virtual
+NGWAPI void        ngw_player_set_frame_info_callback(Player* player, NGW_FRAME_INFO_CALLBACK_TYPE cb);
 //! sets a callback function to be called on stream state change. Equivalent to onState() virtual
 NGWAPI void        ngw_player_set_state_callback(Player* player, NGW_STATE_CALLBACK_TYPE cb);
 //! sets a callback function to be called on stream end. Equivalent to onStreamEnd() virtual
 NGWAPI void        ngw_player_set_stream_end_callback(Player* player, NGW_STREAM_END_CALLBACK_TYPE cb);
+//! sets a callback function to be called when a queued (or looped) media starts. Equivalent to onTrackChanged() virtual
+NGWAPI void        ngw_player_set_track_changed_callback(Player* player, NGW_TRACK_CHANGED_CALLBACK_TYPE cb);
+//! sets a callback function to be called from ngw_player_update() once an async open finishes. Equivalent to onOpened() virtual
+NGWAPI void        ngw_player_set_opened_callback(Player* player, NGW_OPENED_CALLBACK_TYPE cb);
+//! sets a callback function to be called when a seek completes. Equivalent to onSeeked() virtual
+NGWAPI void        ngw_player_set_seeked_callback(Player* player, NGW_SEEKED_CALLBACK_TYPE cb);
+//! average time in milliseconds ngw_player_update() spends per OpenGL texture upload (staging and committing)
+NGWAPI double      ngw_player_get_upload_time(Player* player);
+//! average time in milliseconds spent per OpenGL texture upload copying a frame into a pixel buffer (background)
+NGWAPI double      ngw_player_get_upload_copy_time(Player* player);
+//! leases a frame without copying it. Inside a NGW_BUFFER_CALLBACK_FUNCTION callback, leases the frame being
+//! delivered. Otherwise takes the latest frame kept in NGW_BUFFER_FRAME_LEASE mode (NULL if there is none).
+//! Returned lease MUST be freed with ngw_frame_release(). It can be used and released from any thread
+NGWAPI Frame*      ngw_player_lease_frame(Player* player);
+//! fills in plane pointers, strides and offsets of the frame being delivered. ONLY valid inside a
+//! NGW_BUFFER_CALLBACK_FUNCTION callback. Strides exceed the packed width only with ngw_player_set_padded_frames();
+//! NGW_BUFFER_BYTE_POINTER copies are always packed
+NGWAPI NgwBool     ngw_player_get_frame_layout(Player* player, NgwFrameLayout* layout);
+//! answers pointer to the video data of a leased frame
+NGWAPI unsigned char* ngw_frame_get_data(Frame* frame);
+//! answers size of the video data of a leased frame in bytes
+NGWAPI unsigned    ngw_frame_get_size(Frame* frame);
+//! fills in plane pointers, strides and offsets of a leased frame. Answers false on failure
+NGWAPI NgwBool     ngw_frame_get_layout(Frame* frame, NgwFrameLayout* layout);
+//! fills in layout, timing and sequence of a leased frame
+NGWAPI void        ngw_frame_get_info(Frame* frame, NgwFrameInfo* info);
+//! releases a leased frame and frees its handle
+NGWAPI void        ngw_frame_release(Frame* frame);
+//! sets a user data attached to a DiscovererBatch object. Useful to pass state into callback functions
+NGWAPI void        ngw_discoverer_batch_set_user_data(DiscovererBatch* batch, void *data);
+//! gets a user data attached to a DiscovererBatch object. Useful to obtain a state from callback functions
+NGWAPI void*       ngw_discoverer_batch_get_user_data(DiscovererBatch* batch);
+//! sets a callback function to be called once per added media, from ngw_discoverer_batch_update() or
+//! ngw_discoverer_batch_wait(). Equivalent to onDiscovered() virtual
+NGWAPI void        ngw_discoverer_batch_set_discovered_callback(DiscovererBatch* batch, NGW_DISCOVERED_CALLBACK_TYPE cb);
+//! sets a user data attached to a PlayerManager object. Useful to pass state into callback functions
+NGWAPI void        ngw_manager_set_user_data(PlayerManager* manager, void *data);
+//! gets a user data attached to a PlayerManager object. Useful to obtain a state from callback functions
+NGWAPI void*       ngw_manager_get_user_data(PlayerManager* manager);
+//! sets a callback function to be called for every frame delivered by ngw_manager_update(), on a worker thread if
+//! the manager has workers. Frame passed in is released after the callback. Equivalent to onProcess() virtual
+NGWAPI void        ngw_manager_set_process_callback(PlayerManager* manager, NGW_PROCESS_CALLBACK_TYPE cb);
+//! sets a user data attached to a Thumbnailer object. Useful to pass state into callback functions
+NGWAPI void        ngw_thumbnailer_set_user_data(Thumbnailer* thumbnailer, void *data);
+//! gets a user data attached to a Thumbnailer object. Useful to obtain a state from callback functions
+NGWAPI void*       ngw_thumbnailer_get_user_data(Thumbnailer* thumbnailer);
+//! sets a callback function to be called from ngw_thumbnailer_update() or ngw_thumbnailer_wait() per extracted
+//! frame. The frame passed in MUST be released with ngw_frame_release(). Equivalent to onThumbnail() virtual
+NGWAPI void        ngw_thumbnailer_set_thumbnail_callback(Thumbnailer* thumbnailer, NGW_THUMBNAIL_CALLBACK_TYPE cb);
+//! sets a callback function to be called when a frame could not be extracted. Equivalent to onError() virtual
+NGWAPI void        ngw_thumbnailer_set_error_callback(Thumbnailer* thumbnailer, NGW_THUMBNAILER_ERROR_CALLBACK_TYPE cb);
 
 #ifdef __cplusplus
 } // extern "C"
@@ -1,8 +1,14 @@
 #include "ngw.h"
 #include "ngw.hpp"
 
+#include <utility>
+
+#include <cstdio>
+#include <cstring>
+
 #ifdef __APPLE__
 #   include <OpenGL/gl.h>
+#   include <dlfcn.h>
 #else
 #   ifdef _WIN32
 #       include <windows.h>
@@ -10,33 +16,632 @@
 #   include <GL/gl.h>
 #endif
 
+#ifndef APIENTRY
+#   define APIENTRY
+#endif
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+extern "C" void (*glXGetProcAddressARB(const GLubyte* name))(void);
+#endif
+
+namespace {
+
+// OpenGL 3.0+ entry points used for asynchronous texture uploads. These are
+// loaded at run time since not every platform's gl.h (Windows) exposes them.
+typedef void        (APIENTRY *GL_GEN_BUFFERS)(GLsizei, GLuint*);
+typedef void        (APIENTRY *GL_DELETE_BUFFERS)(GLsizei, const GLuint*);
+typedef void        (APIENTRY *GL_BIND_BUFFER)(GLenum, GLuint);
+typedef void        (APIENTRY *GL_BUFFER_DATA)(GLenum, ptrdiff_t, const void*, GLenum);
+typedef void        (APIENTRY *GL_BUFFER_STORAGE)(GLenum, ptrdiff_t, const void*, GLbitfield);
+typedef void*       (APIENTRY *GL_MAP_BUFFER_RANGE)(GLenum, ptrdiff_t, ptrdiff_t, GLbitfield);
+typedef GLboolean   (APIENTRY *GL_UNMAP_BUFFER)(GLenum);
+typedef void*       (APIENTRY *GL_FENCE_SYNC)(GLenum, GLbitfield);
+typedef GLenum      (APIENTRY *GL_CLIENT_WAIT_SYNC)(void*, GLbitfield, guint64);
+typedef void        (APIENTRY *GL_DELETE_SYNC)(void*);
+typedef const GLubyte* (APIENTRY *GL_GET_STRINGI)(GLenum, GLuint);
+
+const GLenum NGW_GL_BGRA                    = 0x80E1;
+const GLenum NGW_GL_NUM_EXTENSIONS          = 0x821D;
+const GLenum NGW_GL_PIXEL_UNPACK_BUFFER     = 0x88EC;
+const GLenum NGW_GL_STREAM_DRAW             = 0x88E0;
+const GLenum NGW_GL_MAP_WRITE_BIT           = 0x0002;
+const GLenum NGW_GL_MAP_INVALIDATE_BUFFER   = 0x0008;
+const GLenum NGW_GL_MAP_PERSISTENT_BIT      = 0x0040;
+const GLenum NGW_GL_MAP_COHERENT_BIT        = 0x0080;
+const GLenum NGW_GL_SYNC_GPU_COMMANDS       = 0x9117;
+const GLenum NGW_GL_ALREADY_SIGNALED        = 0x911A;
+const GLenum NGW_GL_CONDITION_SATISFIED     = 0x911C;
+const guint  NGW_PIXEL_BUFFER_COUNT         = 3;
+
+struct GlUploadApi
+{
+    GL_GEN_BUFFERS      genBuffers      = nullptr;
+    GL_DELETE_BUFFERS   deleteBuffers   = nullptr;
+    GL_BIND_BUFFER      bindBuffer      = nullptr;
+    GL_BUFFER_DATA      bufferData      = nullptr;
+    GL_BUFFER_STORAGE   bufferStorage   = nullptr;
+    GL_MAP_BUFFER_RANGE mapBufferRange  = nullptr;
+    GL_UNMAP_BUFFER     unmapBuffer     = nullptr;
+    GL_FENCE_SYNC       fenceSync       = nullptr;
+    GL_CLIENT_WAIT_SYNC clientWaitSync  = nullptr;
+    GL_DELETE_SYNC      deleteSync      = nullptr;
+    bool                loaded          = false;
+    bool                supported       = false;    //!< pixel buffers and glMapBufferRange (GL 3.0)
+    bool                persistent      = false;    //!< persistently mapped buffers and fences (GL 4.4)
+};
+
+void* getGlProcAddress(const char* name)
+{
+#if defined(_WIN32)
+    return reinterpret_cast<void*>(::wglGetProcAddress(name));
+#elif defined(__APPLE__)
+    return ::dlsym(RTLD_DEFAULT, name);
+#else
+    return reinterpret_cast<void*>(::glXGetProcAddressARB(reinterpret_cast<const GLubyte*>(name)));
+#endif
+}
+
+// Core profiles (3.1+) reject glGetString(GL_EXTENSIONS), 3.0+ lists extensions one by one
+bool hasGlExtension(const char* name, gint major)
+{
+    GL_GET_STRINGI getStringi = major >= 3 ? GL_GET_STRINGI(getGlProcAddress("glGetStringi")) : nullptr;
+    if (getStringi != nullptr)
+    {
+        GLint count = 0;
+        ::glGetIntegerv(NGW_GL_NUM_EXTENSIONS, &count);
+
+        for (GLint index = 0; index < count; ++index)
+        {
+            const char* extension = reinterpret_cast<const char*>(getStringi(GL_EXTENSIONS, GLuint(index)));
+            if (extension != nullptr && std::strcmp(extension, name) == 0) return true;
+        }
+        return false;
+    }
+
+    // Space separated list, matches whole names only
+    const char* extensions = reinterpret_cast<const char*>(::glGetString(GL_EXTENSIONS));
+    const gsize length = std::strlen(name);
+    for (const char* found = extensions; found != nullptr && (found = std::strstr(found, name)) != nullptr; found += length)
+    {
+        if ((found == extensions || found[-1] == ' ') && (found[length] == ' ' || found[length] == '\0')) return true;
+    }
+    return false;
+}
+
+// Must be called with a current OpenGL context
+const GlUploadApi& getGlUploadApi()
+{
+    static GlUploadApi api;
+    if (api.loaded) return api;
+    api.loaded = true;
+
+    gint major = 0, minor = 0;
+    if (const char* version = reinterpret_cast<const char*>(::glGetString(GL_VERSION)))
+    {
+        // Skips "OpenGL ES " prefix if any
+        while (*version != '\0' && (*version < '0' || *version > '9')) ++version;
+        std::sscanf(version, "%d.%d", &major, &minor);
+    }
+
+    api.genBuffers      = GL_GEN_BUFFERS(getGlProcAddress("glGenBuffers"));
+    api.deleteBuffers   = GL_DELETE_BUFFERS(getGlProcAddress("glDeleteBuffers"));
+    api.bindBuffer      = GL_BIND_BUFFER(getGlProcAddress("glBindBuffer"));
+    api.bufferData      = GL_BUFFER_DATA(getGlProcAddress("glBufferData"));
+    api.bufferStorage   = GL_BUFFER_STORAGE(getGlProcAddress("glBufferStorage"));
+    api.mapBufferRange  = GL_MAP_BUFFER_RANGE(getGlProcAddress("glMapBufferRange"));
+    api.unmapBuffer     = GL_UNMAP_BUFFER(getGlProcAddress("glUnmapBuffer"));
+    api.fenceSync       = GL_FENCE_SYNC(getGlProcAddress("glFenceSync"));
+    api.clientWaitSync  = GL_CLIENT_WAIT_SYNC(getGlProcAddress("glClientWaitSync"));
+    api.deleteSync      = GL_DELETE_SYNC(getGlProcAddress("glDeleteSync"));
+
+    api.supported = major >= 3 &&
+        api.genBuffers && api.deleteBuffers && api.bindBuffer && api.bufferData &&
+        api.mapBufferRange && api.unmapBuffer;
+
+    api.persistent = api.supported &&
+        (major > 4 || (major == 4 && minor >= 4) || hasGlExtension("GL_ARB_buffer_storage", major)) &&
+        (major > 3 || (major == 3 && minor >= 2) || hasGlExtension("GL_ARB_sync", major)) &&
+        api.bufferStorage && api.fenceSync && api.clientWaitSync && api.deleteSync;
+
+    return api;
+}
+
+/*!
+ * Ring of pixel buffer objects used to upload frames into an OpenGL texture
+ * without stalling on client memory. A frame is staged into a free pixel
+ * buffer and copied there on a background thread. The next commit() issues
+ * an asynchronous glTexSubImage2D out of the most recently filled buffer.
+ * Buffers are persistently mapped and fenced on reuse (GL 4.4), otherwise
+ * orphaned and mapped again on every use (GL 3.0).
+ */
+class UploadRing final
+{
+public:
+    UploadRing();
+    ~UploadRing();
+    //! stages a frame for upload. false if pixel buffers are not supported. Needs a current GL context
+    bool        stage(ngw::Frame&& frame);
+    //! uploads the most recently filled pixel buffer into texture. Needs a current GL context
+    void        commit(GLuint texture, GLint width, GLint height);
+    //! average time spent in stage() and commit() per uploaded frame, in milliseconds
+    gdouble     getUploadTime() const;
+    //! average time spent copying a frame on the background thread, in milliseconds
+    gdouble     getCopyTime() const;
+
+private:
+    enum SlotState { SLOT_FREE = 0, SLOT_FILLING, SLOT_FILLED, SLOT_IN_FLIGHT };
+
+    struct Slot
+    {
+        GLuint          pbo         = 0;
+        gpointer        data        = nullptr;  //!< mapped storage of pbo
+        void*           fence       = nullptr;  //!< GLsync, signaled once GPU is done reading pbo
+        guint64         sequence    = 0;        //!< order in which frames were staged
+        volatile gint   state       = SLOT_FREE;
+    };
+
+    struct CopyJob
+    {
+        CopyJob(UploadRing* r, Slot* s, ngw::Frame&& f) : ring(r), slot(s), frame(std::move(f)) {}
+        UploadRing      *ring;
+        Slot            *slot;
+        ngw::Frame      frame;
+    };
+
+    static void copy(gpointer job, gpointer);
+    bool        allocate(gsize size);
+    void        release();
+    void        recycle(Slot& slot);
+
+    GThreadPool     *mCopyPool;
+    Slot            mSlots[NGW_PIXEL_BUFFER_COUNT];
+    gsize           mSize           = 0;
+    guint64         mSequence       = 0;
+    guint64         mCommitted      = 0;
+    gint64          mUploadTime     = 0;        //!< accumulated, microseconds
+    guint64         mUploadCount    = 0;
+    mutable GMutex  mCopyLock;                  //!< Guards copy timings, shared with the copy thread
+    gint64          mCopyTime       = 0;        //!< accumulated, microseconds
+    guint64         mCopyCount      = 0;
+};
+
+UploadRing::UploadRing()
+{
+    // One thread keeps frames of a player in order
+    mCopyPool = g_thread_pool_new(&UploadRing::copy, nullptr, 1, FALSE, nullptr);
+    g_mutex_init(&mCopyLock);
+}
+
+UploadRing::~UploadRing()
+{
+    // Waits for pending copies to finish
+    g_thread_pool_free(mCopyPool, FALSE, TRUE);
+    release();
+    g_mutex_clear(&mCopyLock);
+}
+
+void UploadRing::copy(gpointer data, gpointer)
+{
+    CopyJob* job = static_cast<CopyJob*>(data);
+    gint64 start = g_get_monotonic_time();
+
+    std::memcpy(job->slot->data, job->frame.getData(), MIN(job->frame.getSize(), job->ring->mSize));
+    job->frame.release();
+
+    g_mutex_lock(&job->ring->mCopyLock);
+    job->ring->mCopyTime += g_get_monotonic_time() - start;
+    job->ring->mCopyCount++;
+    g_mutex_unlock(&job->ring->mCopyLock);
+    g_atomic_int_set(&job->slot->state, SLOT_FILLED);
+    delete job;
+}
+
+bool UploadRing::allocate(gsize size)
+{
+    const GlUploadApi& gl = getGlUploadApi();
+    if (!gl.supported) return false;
+    if (size == mSize) return true;
+
+    release();
+
+    for (Slot& slot : mSlots)
+    {
+        gl.genBuffers(1, &slot.pbo);
+        gl.bindBuffer(NGW_GL_PIXEL_UNPACK_BUFFER, slot.pbo);
+
+        if (gl.persistent)
+        {
+            const GLbitfield flags = NGW_GL_MAP_WRITE_BIT | NGW_GL_MAP_PERSISTENT_BIT | NGW_GL_MAP_COHERENT_BIT;
+            gl.bufferStorage(NGW_GL_PIXEL_UNPACK_BUFFER, ptrdiff_t(size), nullptr, flags);
+            slot.data = gl.mapBufferRange(NGW_GL_PIXEL_UNPACK_BUFFER, 0, ptrdiff_t(size), flags);
+        }
+        else
+        {
+            gl.bufferData(NGW_GL_PIXEL_UNPACK_BUFFER, ptrdiff_t(size), nullptr, NGW_GL_STREAM_DRAW);
+        }
+    }
+
+    gl.bindBuffer(NGW_GL_PIXEL_UNPACK_BUFFER, 0);
+    mSize = size;
+    return true;
+}
+
+void UploadRing::release()
+{
+    if (mSize == 0) return;
+    const GlUploadApi& gl = getGlUploadApi();
+
+    // Copies must not write into buffers being freed
+    for (Slot& slot : mSlots)
+    {
+        while (g_atomic_int_get(&slot.state) == SLOT_FILLING) g_usleep(100);
+    }
+
+    for (Slot& slot : mSlots)
+    {
+        if (slot.data != nullptr)
+        {
+            gl.bindBuffer(NGW_GL_PIXEL_UNPACK_BUFFER, slot.pbo);
+            gl.unmapBuffer(NGW_GL_PIXEL_UNPACK_BUFFER);
+        }
+
+        if (slot.fence != nullptr) gl.deleteSync(slot.fence);
+        gl.deleteBuffers(1, &slot.pbo);
+        slot = Slot();
+    }
+
+    gl.bindBuffer(NGW_GL_PIXEL_UNPACK_BUFFER, 0);
+    mSize = 0;
+}
+
+void UploadRing::recycle(Slot& slot)
+{
+    const GlUploadApi& gl = getGlUploadApi();
+
+    if (slot.fence != nullptr)
+    {
+        // Not blocking, a buffer still read by the GPU is simply not reused yet
+        GLenum result = gl.clientWaitSync(slot.fence, 0, 0);
+        if (result != NGW_GL_ALREADY_SIGNALED && result != NGW_GL_CONDITION_SATISFIED) return;
+
+        gl.deleteSync(slot.fence);
+        slot.fence = nullptr;
+    }
+
+    g_atomic_int_set(&slot.state, SLOT_FREE);
+}
+
+bool UploadRing::stage(ngw::Frame&& frame)
+{
+    gint64 start = g_get_monotonic_time();
+    if (!frame.isValid() || !allocate(frame.getSize())) return false;
+
+    const GlUploadApi& gl = getGlUploadApi();
+    Slot* free_slot = nullptr;
+
+    for (Slot& slot : mSlots)
+    {
+        if (g_atomic_int_get(&slot.state) == SLOT_IN_FLIGHT) recycle(slot);
+        if (free_slot == nullptr && g_atomic_int_get(&slot.state) == SLOT_FREE) free_slot = &slot;
+    }
+
+    // All buffers busy, GPU is behind. Simply, skip this frame.
+    if (free_slot == nullptr) return true;
+
+    if (!gl.persistent)
+    {
+        // Orphan the old storage so mapping does not wait for the GPU
+        gl.bindBuffer(NGW_GL_PIXEL_UNPACK_BUFFER, free_slot->pbo);
+        gl.bufferData(NGW_GL_PIXEL_UNPACK_BUFFER, ptrdiff_t(mSize), nullptr, NGW_GL_STREAM_DRAW);
+        free_slot->data = gl.mapBufferRange(NGW_GL_PIXEL_UNPACK_BUFFER, 0, ptrdiff_t(mSize),
+            NGW_GL_MAP_WRITE_BIT | NGW_GL_MAP_INVALIDATE_BUFFER);
+        gl.bindBuffer(NGW_GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    if (free_slot->data == nullptr) return false;
+
+    free_slot->sequence = ++mSequence;
+    g_atomic_int_set(&free_slot->state, SLOT_FILLING);
+    g_thread_pool_push(mCopyPool, new CopyJob(this, free_slot, std::move(frame)), nullptr);
+
+    mUploadTime += g_get_monotonic_time() - start;
+    return true;
+}
+
+void UploadRing::commit(GLuint texture, GLint width, GLint height)
+{
+    if (mSize == 0) return;
+
+    gint64 start = g_get_monotonic_time();
+    const GlUploadApi& gl = getGlUploadApi();
+    Slot* latest = nullptr;
+
+    for (Slot& slot : mSlots)
+    {
+        if (g_atomic_int_get(&slot.state) == SLOT_FILLED &&
+            slot.sequence > mCommitted &&
+            (latest == nullptr || slot.sequence > latest->sequence))
+        {
+            latest = &slot;
+        }
+    }
+
+    if (latest == nullptr) return;
+
+    for (Slot& slot : mSlots)
+    {
+        if (&slot == latest || g_atomic_int_get(&slot.state) != SLOT_FILLED) continue;
+
+        // An older frame that was never uploaded, superseded by latest
+        if (!gl.persistent)
+        {
+            gl.bindBuffer(NGW_GL_PIXEL_UNPACK_BUFFER, slot.pbo);
+            gl.unmapBuffer(NGW_GL_PIXEL_UNPACK_BUFFER);
+            slot.data = nullptr;
+        }
+
+        g_atomic_int_set(&slot.state, SLOT_FREE);
+    }
+
+    gl.bindBuffer(NGW_GL_PIXEL_UNPACK_BUFFER, latest->pbo);
+
+    if (!gl.persistent)
+    {
+        gl.unmapBuffer(NGW_GL_PIXEL_UNPACK_BUFFER);
+        latest->data = nullptr;
+    }
+
+    // Sourced from the bound pixel buffer, returns without waiting for the transfer
+    ::glBindTexture(GL_TEXTURE_2D, texture);
+    ::glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, NGW_GL_BGRA, GL_UNSIGNED_BYTE, nullptr);
+    ::glBindTexture(GL_TEXTURE_2D, 0);
+    gl.bindBuffer(NGW_GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if (gl.persistent)
+    {
+        latest->fence = gl.fenceSync(NGW_GL_SYNC_GPU_COMMANDS, 0);
+        g_atomic_int_set(&latest->state, SLOT_IN_FLIGHT);
+    }
+    else
+    {
+        // Orphaned on next use, GPU keeps reading the old storage
+        g_atomic_int_set(&latest->state, SLOT_FREE);
+    }
+
+    mCommitted = latest->sequence;
+    mUploadTime += g_get_monotonic_time() - start;
+    mUploadCount++;
+}
+
+gdouble UploadRing::getUploadTime() const
+{
+    return mUploadCount == 0 ? 0. : mUploadTime / (1000. * mUploadCount);
+}
+
+gdouble UploadRing::getCopyTime() const
+{
+    g_mutex_lock(&mCopyLock);
+    const gdouble time = mCopyCount == 0 ? 0. : mCopyTime / (1000. * mCopyCount);
+    g_mutex_unlock(&mCopyLock);
+    return time;
+}
+
+/*!
+ * Three caller owned byte buffers rotated between a producer (the thread
+ * calling ngw_player_update()) and a consumer on any thread. Producer fills
+ * the back buffer and swaps it with the middle one, consumer swaps the middle
+ * one into the front when it is newer. Roles live in a single atomic word,
+ * so neither side ever waits and a front buffer is never written while held.
+ */
+class TripleBuffer final
+{
+public:
+    //! sets buffers of size bytes each, nullptr turns it off. NOT safe while the consumer holds a buffer
+    void            set(guchar* const* buffers, gsize size);
+    //! false if no buffers are set
+    bool            isSet() const;
+    //! answers bytes each buffer holds
+    gsize           getSize() const { return mSize; }
+    //! answers the buffer a frame is copied into before publish(...). Producer ONLY
+    guchar*         getBack() const;
+    //! publishes the back buffer holding frame of sequence. Producer ONLY
+    void            publish(guint64 sequence);
+    //! answers latest published buffer and its sequence, nullptr if none. Consumer ONLY
+    guchar*         acquire(guint64* sequence);
+    //! gives the front buffer back, the next acquire(...) may swap it. Consumer ONLY
+    void            release();
+
+private:
+    // Index of back buffer in bits 0-1, middle in 2-3, front in 4-5 and whether middle is newer than front in 6
+    enum { BACK = 0, MIDDLE = 2, FRONT = 4, FRESH = 1 << 6, INITIAL = (0 << BACK) | (1 << MIDDLE) | (2 << FRONT) };
+
+    static gint     index(gint state, gint role) { return (state >> role) & 3; }
+
+    guchar          *mBuffers[3]    = { nullptr, nullptr, nullptr };
+    guint64         mSequences[3]   = { 0, 0, 0 };
+    gsize           mSize           = 0;
+    volatile gint   mState          = INITIAL;
+    gboolean        mHeld           = FALSE;    //!< Consumer holds the front buffer
+};
+
+void TripleBuffer::set(guchar* const* buffers, gsize size)
+{
+    mSize = buffers != nullptr ? size : 0;
+
+    for (gint index = 0; index < 3; ++index)
+    {
+        mBuffers[index]     = buffers != nullptr ? buffers[index] : nullptr;
+        mSequences[index]   = 0;
+    }
+
+    mHeld = FALSE;
+    g_atomic_int_set(&mState, INITIAL);
+}
+
+bool TripleBuffer::isSet() const
+{
+    return mBuffers[0] != nullptr && mBuffers[1] != nullptr && mBuffers[2] != nullptr;
+}
+
+guchar* TripleBuffer::getBack() const
+{
+    return mBuffers[index(g_atomic_int_get(&mState), BACK)];
+}
+
+void TripleBuffer::publish(guint64 sequence)
+{
+    gint state = g_atomic_int_get(&mState);
+    const gint back = index(state, BACK);
+
+    mSequences[back] = sequence;
+
+    // Back buffer becomes the middle one, whatever the consumer did meanwhile
+    gint next = 0;
+    do
+    {
+        state   = g_atomic_int_get(&mState);
+        next    = (index(state, MIDDLE) << BACK) | (back << MIDDLE) | (index(state, FRONT) << FRONT) | FRESH;
+    }
+    while (g_atomic_int_compare_and_exchange(&mState, state, next) == FALSE);
+}
+
+guchar* TripleBuffer::acquire(guint64* sequence)
+{
+    if (!isSet()) return nullptr;
+
+    gint state = g_atomic_int_get(&mState);
+
+    // Held buffer stays put until release(), acquiring again must not invalidate it
+    while (!mHeld && (state & FRESH) != 0)
+    {
+        const gint next = (index(state, BACK) << BACK) | (index(state, FRONT) << MIDDLE) | (index(state, MIDDLE) << FRONT);
+        if (g_atomic_int_compare_and_exchange(&mState, state, next) != FALSE)
+        {
+            state = next;
+            break;
+        }
+
+        state = g_atomic_int_get(&mState);
+    }
+
+    const gint front = index(state, FRONT);
+
+    // Nothing published yet
+    if (mSequences[front] == 0)
+        return nullptr;
+
+    mHeld = TRUE;
+    if (sequence != nullptr) *sequence = mSequences[front];
+    return mBuffers[front];
+}
+
+void TripleBuffer::release()
+{
+    mHeld = FALSE;
+}
+
+// Copies a layout into its ABI stable counterpart
+NgwBool toNgwLayout(const ngw::FrameLayout& src, NgwFrameLayout* dst, bool success)
+{
+    static_assert(NGW_MAX_PLANES == ngw::FrameLayout::MAX_PLANES, "Plane count mismatch.");
+
+    dst->format = src.format;
+    dst->width  = src.width;
+    dst->height = src.height;
+    dst->planes = src.planes;
+
+    for (guint plane = 0; plane < NGW_MAX_PLANES; ++plane)
+    {
+        dst->data[plane]    = src.data[plane];
+        dst->offset[plane]  = src.offset[plane];
+        dst->stride[plane]  = src.stride[plane];
+    }
+
+    return success ? NGW_BOOL_TRUE : NGW_BOOL_FALSE;
+}
+
+// Copies a frame descriptor into its ABI stable counterpart
+void toNgwInfo(const ngw::FrameInfo& src, NgwFrameInfo* dst)
+{
+    toNgwLayout(src.layout, &dst->layout, true);
+
+    dst->pts            = src.pts;
+    dst->duration       = src.duration;
+    dst->running_time   = src.runningTime;
+    dst->present_time   = src.presentTime;
+    dst->arrival_time   = src.arrivalTime;
+    dst->sequence       = src.sequence;
+}
+
+} // !namespace
+
+struct _Frame final : public ngw::Frame {
+    _Frame(ngw::Frame&& frame) : ngw::Frame(std::move(frame)) {}
+};
+
 struct _Player final : public ngw::Player {
 public:
+    ~_Player();
     void        setUserData(gpointer data);
     gpointer    getUserData() const;
     void        setFrameBuffer(void* buffer, NgwBuffer type);
     void        setFrameDirtyFlag(gboolean *flag);
+    void        setFrameBufferSize(gsize size);
+    void        setTripleBuffer(guchar* const* buffers, gsize size);
+    guchar*     acquireLatest(guint64* sequence);
+    void        releaseLatest();
     void        setErrorCallback(NGW_ERROR_CALLBACK_TYPE cb);
     void        setStateCallback(NGW_STATE_CALLBACK_TYPE cb);
     void        setStreamEndCallback(NGW_STREAM_END_CALLBACK_TYPE cb);
+    void        setTrackChangedCallback(NGW_TRACK_CHANGED_CALLBACK_TYPE cb);
+    void        setOpenedCallback(NGW_OPENED_CALLBACK_TYPE cb);
+    void        setSeekedCallback(NGW_SEEKED_CALLBACK_TYPE cb);
+    void        setFrameInfoCallback(NGW_FRAME_INFO_CALLBACK_TYPE cb);
+    Frame*      leaseFrame();
+    NgwBool     getFrameLayout(NgwFrameLayout* layout) const;
+    void        commitUpload();
+    gdouble     getUploadTime() const;
+    gdouble     getUploadCopyTime() const;
+    gint        getPoolIndex() const;
 
 protected:
     void        onFrame(guchar* buf, gsize size) const override;
+    void        onFrameInfo(const ngw::FrameInfo& info, guchar* buf, gsize size) const override;
     void        onError(const gchar* msg) const override;
     void        onState(GstState state) const override;
     void        onStreamEnd() const override;
+    void        onTrackChanged(const gchar* uri) const override;
+    void        onOpened(bool success) const override;
+    void        onSeeked(gdouble latency) const override;
 
 private:
     gboolean    *mDirtyFlag = nullptr;
     gpointer    mBuffer     = nullptr;
+    gsize       mBufferSize = 0;            //!< Bytes mBuffer holds, 0 if the caller did not tell
     gpointer    mUserData   = nullptr;
     NgwBuffer   mBufferType = NGW_BUFFER_BYTE_POINTER;
+    mutable gpointer mLatestFrame = nullptr;
+    mutable Frame*  mPoolFrame  = nullptr;
+    mutable gint    mPoolIndex  = -1;
+    mutable UploadRing mUploadRing;
+    mutable TripleBuffer mTripleBuffer;
 
     NGW_ERROR_CALLBACK_TYPE         mErrorCallback      = nullptr;
     NGW_STATE_CALLBACK_TYPE         mStateCallback      = nullptr;
     NGW_STREAM_END_CALLBACK_TYPE    mStreamEndCallback  = nullptr;
+    NGW_TRACK_CHANGED_CALLBACK_TYPE mTrackChangedCallback = nullptr;
+    NGW_OPENED_CALLBACK_TYPE        mOpenedCallback     = nullptr;
+    NGW_SEEKED_CALLBACK_TYPE        mSeekedCallback     = nullptr;
+    NGW_FRAME_INFO_CALLBACK_TYPE    mFrameInfoCallback  = nullptr;
 };
 
+_Player::~_Player()
+{
+    // Frame being delivered does not need to be tracked beyond this point
+    delete static_cast<Frame*>(g_atomic_pointer_get(&mLatestFrame));
+    delete mPoolFrame;
+}
+
 void _Player::setUserData(gpointer data)
 {
     mUserData = data;
@@ -54,14 +659,81 @@ void _Player::setFrameBuffer(void* buffer, NgwBuffer type)
     mBuffer = buffer;
 }
 
+void _Player::setFrameBufferSize(gsize size)
+{
+    mBufferSize = size;
+}
+
+void _Player::setTripleBuffer(guchar* const* buffers, gsize size)
+{
+    mTripleBuffer.set(buffers, size);
+    setFrameBuffer(nullptr, buffers != nullptr ? NGW_BUFFER_TRIPLE_BUFFER : NGW_BUFFER_BYTE_POINTER);
+}
+
+guchar* _Player::acquireLatest(guint64* sequence)
+{
+    return mTripleBuffer.acquire(sequence);
+}
+
+void _Player::releaseLatest()
+{
+    mTripleBuffer.release();
+}
+
 void _Player::onFrame(guchar* buf, gsize size) const
 {
+    // Published from onFrameInfo(...) which knows the frame's sequence
+    if (mBufferType == NGW_BUFFER_TRIPLE_BUFFER)
+        return;
+
+    if (mBufferType == NGW_BUFFER_FRAME_LEASE)
+    {
+        gpointer previous = nullptr;
+        Frame* frame = new Frame(ngw::Player::leaseFrame());
+
+        // Latest frame wins, an unclaimed previous one is released
+        do { previous = g_atomic_pointer_get(&mLatestFrame); }
+        while (g_atomic_pointer_compare_and_exchange(&mLatestFrame, previous, frame) == FALSE);
+        delete static_cast<Frame*>(previous);
+
+        if (mDirtyFlag != nullptr)
+            *mDirtyFlag = NGW_BOOL_TRUE;
+
+        return;
+    }
+
+    if (mBufferType == NGW_BUFFER_BYTE_POINTER)
+    {
+        delete mPoolFrame;
+        mPoolFrame = nullptr;
+        mPoolIndex = getFramePoolIndex();
+    }
+
+    // Frame already sits in caller's memory, hold it until the next one instead of copying
+    if (mPoolIndex >= 0 && mBufferType == NGW_BUFFER_BYTE_POINTER)
+    {
+        mPoolFrame = new Frame(ngw::Player::leaseFrame());
+
+        if (mDirtyFlag != nullptr)
+            *mDirtyFlag = NGW_BOOL_TRUE;
+
+        return;
+    }
+
     if (mBuffer == nullptr)
         return;
 
     if (mBufferType == NGW_BUFFER_BYTE_POINTER)
     {
-        gst_buffer_extract(getBuffer(), 0, mBuffer, size);
+        // Padding of the decoder is removed while copying. Without a size, caller sized the buffer for the opened media
+        const gsize copied = copyFrame(static_cast<guchar*>(mBuffer), mBufferSize > 0 ? mBufferSize : G_MAXSIZE);
+        if (copied == 0)
+        {
+            addDroppedFrame(ngw::FRAME_DROP_COPY);
+            return;
+        }
+
+        addCopiedBytes(copied);
 
         if (mDirtyFlag != nullptr)
             *mDirtyFlag = NGW_BOOL_TRUE;
@@ -75,59 +747,362 @@ void _Player::onFrame(guchar* buf, gsize size) const
     }
     else if (mBufferType == NGW_BUFFER_OPENGL_TEXTURE)
     {
+        addCopiedBytes(size);
+
+        // Rows of a padded frame are further apart than the pixel buffers expect
+        ngw::FrameLayout layout;
+        const GLint row_length = getPaddedFrames() && ngw::Player::getFrameLayout(layout) ? layout.stride[0] / 4 : 0;
+        const guchar* pixels = row_length > 0 ? layout.data[0] : buf;
+
+        // Uploaded asynchronously on the next commitUpload()
+        if (row_length == getWidth() || row_length == 0)
+        {
+            if (mUploadRing.stage(ngw::Player::leaseFrame()))
+                return;
+        }
+
+        // Pixel buffers are not available, upload straight from client memory
         ::glBindTexture(GL_TEXTURE_2D, (GLuint)(gsize)mBuffer);
+        ::glPixelStorei(GL_UNPACK_ROW_LENGTH, row_length);
         ::glTexSubImage2D(
             GL_TEXTURE_2D,
             0, 0, 0,
             getWidth(),
             getHeight(),
-            0x80E1, // GL_BGRA
+            NGW_GL_BGRA,
             GL_UNSIGNED_BYTE,
-            buf);
+            pixels);
+        ::glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
         ::glBindTexture(GL_TEXTURE_2D, 0);
     }
 }
 
-void _Player::setErrorCallback(NGW_ERROR_CALLBACK_TYPE cb)
-{
-    mErrorCallback = cb;
-}
+void _Player::commitUpload()
+{
+    if (mBufferType == NGW_BUFFER_OPENGL_TEXTURE && mBuffer != nullptr)
+        mUploadRing.commit((GLuint)(gsize)mBuffer, getWidth(), getHeight());
+}
+
+gdouble _Player::getUploadTime() const
+{
+    return mUploadRing.getUploadTime();
+}
+
+gdouble _Player::getUploadCopyTime() const
+{
+    return mUploadRing.getCopyTime();
+}
+
+void _Player::setErrorCallback(NGW_ERROR_CALLBACK_TYPE cb)
+{
+    mErrorCallback = cb;
+}
+
+void _Player::setStateCallback(NGW_STATE_CALLBACK_TYPE cb)
+{
+    mStateCallback = cb;
+}
+
+void _Player::setStreamEndCallback(NGW_STREAM_END_CALLBACK_TYPE cb)
+{
+    mStreamEndCallback = cb;
+}
+
+void _Player::setTrackChangedCallback(NGW_TRACK_CHANGED_CALLBACK_TYPE cb)
+{
+    mTrackChangedCallback = cb;
+}
+
+void _Player::setOpenedCallback(NGW_OPENED_CALLBACK_TYPE cb)
+{
+    mOpenedCallback = cb;
+}
+
+void _Player::setSeekedCallback(NGW_SEEKED_CALLBACK_TYPE cb)
+{
+    mSeekedCallback = cb;
+}
+
+void _Player::setFrameInfoCallback(NGW_FRAME_INFO_CALLBACK_TYPE cb)
+{
+    mFrameInfoCallback = cb;
+}
+
+void _Player::onFrameInfo(const ngw::FrameInfo& info, guchar* buf, gsize size) const
+{
+    if (mBufferType == NGW_BUFFER_TRIPLE_BUFFER && mTripleBuffer.isSet())
+    {
+        // Padding of the decoder is removed while copying, a frame bigger than the buffers is not published
+        const gsize copied = copyFrame(mTripleBuffer.getBack(), mTripleBuffer.getSize());
+        if (copied > 0)
+        {
+            addCopiedBytes(copied);
+            mTripleBuffer.publish(info.sequence);
+
+            if (mDirtyFlag != nullptr)
+                *mDirtyFlag = NGW_BOOL_TRUE;
+        }
+        else
+        {
+            addDroppedFrame(ngw::FRAME_DROP_COPY);
+        }
+    }
+
+    if (mFrameInfoCallback == nullptr)
+        return;
+
+    NgwFrameInfo frame_info;
+    toNgwInfo(info, &frame_info);
+    mFrameInfoCallback(&frame_info, buf, static_cast<unsigned int>(size), this);
+}
+
+void _Player::onError(const gchar* msg) const
+{
+    if (mErrorCallback != nullptr)
+        mErrorCallback(msg, this);
+}
+
+void _Player::onState(GstState state) const
+{
+    if (mStateCallback != nullptr)
+        mStateCallback(int(state), this);
+}
+
+void _Player::onStreamEnd() const
+{
+    if (mStreamEndCallback != nullptr)
+        mStreamEndCallback(this);
+}
+
+void _Player::onTrackChanged(const gchar* uri) const
+{
+    if (mTrackChangedCallback != nullptr)
+        mTrackChangedCallback(uri, this);
+}
+
+void _Player::onOpened(bool success) const
+{
+    if (mOpenedCallback != nullptr)
+        mOpenedCallback(success ? NGW_BOOL_TRUE : NGW_BOOL_FALSE, this);
+}
+
+void _Player::onSeeked(gdouble latency) const
+{
+    if (mSeekedCallback != nullptr)
+        mSeekedCallback(latency, this);
+}
+
+void _Player::setFrameDirtyFlag(gboolean *flag)
+{
+    mDirtyFlag = flag;
+}
+
+gint _Player::getPoolIndex() const
+{
+    return mPoolIndex;
+}
+
+Frame* _Player::leaseFrame()
+{
+    // Inside a frame callback
+    if (getSample() != nullptr)
+        return new Frame(ngw::Player::leaseFrame());
+
+    gpointer frame = nullptr;
+    do { frame = g_atomic_pointer_get(&mLatestFrame); }
+    while (frame != nullptr && g_atomic_pointer_compare_and_exchange(&mLatestFrame, frame, nullptr) == FALSE);
+
+    return static_cast<Frame*>(frame);
+}
+
+NgwBool _Player::getFrameLayout(NgwFrameLayout* layout) const
+{
+    ngw::FrameLayout frame_layout;
+    bool success = getSample() != nullptr && ngw::Player::getFrameLayout(frame_layout);
+    return toNgwLayout(frame_layout, layout, success);
+}
+
+struct _Discoverer  final : public ngw::Discoverer {
+    _Discoverer() = default;
+    _Discoverer(const ngw::Discoverer& discoverer) : ngw::Discoverer(discoverer) {}
+};
+
+struct _DiscovererBatch final : public ngw::DiscovererBatch {
+public:
+    _DiscovererBatch(guint workers) : ngw::DiscovererBatch(workers) {}
+    void        setUserData(gpointer data);
+    gpointer    getUserData() const;
+    void        setDiscoveredCallback(NGW_DISCOVERED_CALLBACK_TYPE cb);
+
+protected:
+    void        onDiscovered(const ngw::Discoverer& discoverer, bool success) const override;
+
+private:
+    gpointer    mUserData   = nullptr;
+
+    NGW_DISCOVERED_CALLBACK_TYPE    mDiscoveredCallback = nullptr;
+};
+
+void _DiscovererBatch::setUserData(gpointer data)
+{
+    mUserData = data;
+}
+
+gpointer _DiscovererBatch::getUserData() const
+{
+    return mUserData;
+}
+
+void _DiscovererBatch::setDiscoveredCallback(NGW_DISCOVERED_CALLBACK_TYPE cb)
+{
+    mDiscoveredCallback = cb;
+}
+
+void _DiscovererBatch::onDiscovered(const ngw::Discoverer& discoverer, bool success) const
+{
+    if (mDiscoveredCallback != nullptr)
+    {
+        Discoverer typed(discoverer);
+        mDiscoveredCallback(&typed, success ? NGW_BOOL_TRUE : NGW_BOOL_FALSE, this);
+    }
+}
+
+struct _PlayerGroup final : public ngw::PlayerGroup { };
+
+struct _PlayerManager final : public ngw::PlayerManager {
+public:
+    _PlayerManager(guint workers) : ngw::PlayerManager(workers) {}
+    ~_PlayerManager();
+    void        setUserData(gpointer data);
+    gpointer    getUserData() const;
+    void        setProcessCallback(NGW_PROCESS_CALLBACK_TYPE cb);
+    guint       update(NgwPlayerState* states, guint count, gint64 vblank);
+
+protected:
+    void        onProcess(const ngw::Player& player, ngw::Frame& frame) const override;
+
+private:
+    gpointer    mUserData   = nullptr;
+    ngw::PlayerState *mStates = nullptr;
+    guint       mCapacity   = 0;
+
+    NGW_PROCESS_CALLBACK_TYPE           mProcessCallback    = nullptr;
+};
+
+_PlayerManager::~_PlayerManager()
+{
+    delete[] mStates;
+}
+
+void _PlayerManager::setUserData(gpointer data)
+{
+    mUserData = data;
+}
+
+gpointer _PlayerManager::getUserData() const
+{
+    return mUserData;
+}
+
+void _PlayerManager::setProcessCallback(NGW_PROCESS_CALLBACK_TYPE cb)
+{
+    mProcessCallback = cb;
+}
+
+guint _PlayerManager::update(NgwPlayerState* states, guint count, gint64 vblank)
+{
+    if (states != nullptr && count > mCapacity)
+    {
+        delete[] mStates;
+        mStates     = new ngw::PlayerState[count];
+        mCapacity   = count;
+    }
+
+    const guint filled = ngw::PlayerManager::update(states != nullptr ? mStates : nullptr, count, vblank);
+
+    // Same as ngw_player_update(), uploads are committed on the calling thread
+    for (guint index = 0; index < getSize(); ++index)
+        static_cast<Player*>(getPlayer(index))->commitUpload();
+
+    for (guint index = 0; index < filled; ++index)
+    {
+        const ngw::PlayerState& src = mStates[index];
+        NgwPlayerState& dst = states[index];
+
+        dst.player      = static_cast<const Player*>(src.player);
+        dst.state       = NgwState(src.state);
+        dst.time        = src.time;
+        dst.duration    = src.duration;
+        dst.width       = src.width;
+        dst.height      = src.height;
+        dst.sequence    = src.sequence;
+    }
+
+    return filled;
+}
+
+void _PlayerManager::onProcess(const ngw::Player& player, ngw::Frame& frame) const
+{
+    if (mProcessCallback == nullptr)
+        return;
+
+    // Lease handed to the callee is only valid inside the callback
+    Frame lease(std::move(frame));
+    mProcessCallback(&lease, static_cast<const Player*>(&player), this);
+}
+
+struct _Thumbnailer final : public ngw::Thumbnailer {
+public:
+    _Thumbnailer(guint pipelines) : ngw::Thumbnailer(pipelines) {}
+    void        setUserData(gpointer data);
+    gpointer    getUserData() const;
+    void        setThumbnailCallback(NGW_THUMBNAIL_CALLBACK_TYPE cb);
+    void        setErrorCallback(NGW_THUMBNAILER_ERROR_CALLBACK_TYPE cb);
+
+protected:
+    void        onThumbnail(gdouble time, ngw::Frame& frame) const override;
+    void        onError(const gchar* msg) const override;
+
+private:
+    gpointer    mUserData   = nullptr;
+
+    NGW_THUMBNAIL_CALLBACK_TYPE         mThumbnailCallback  = nullptr;
+    NGW_THUMBNAILER_ERROR_CALLBACK_TYPE mErrorCallback      = nullptr;
+};
 
-void _Player::setStateCallback(NGW_STATE_CALLBACK_TYPE cb)
+void _Thumbnailer::setUserData(gpointer data)
 {
-    mStateCallback = cb;
+    mUserData = data;
 }
 
-void _Player::setStreamEndCallback(NGW_STREAM_END_CALLBACK_TYPE cb)
+gpointer _Thumbnailer::getUserData() const
 {
-    mStreamEndCallback = cb;
+    return mUserData;
 }
 
-void _Player::onError(const gchar* msg) const
+void _Thumbnailer::setThumbnailCallback(NGW_THUMBNAIL_CALLBACK_TYPE cb)
 {
-    if (mErrorCallback != nullptr)
-        mErrorCallback(msg, this);
+    mThumbnailCallback = cb;
 }
 
-void _Player::onState(GstState state) const
+void _Thumbnailer::setErrorCallback(NGW_THUMBNAILER_ERROR_CALLBACK_TYPE cb)
 {
-    if (mStateCallback != nullptr)
-        mStateCallback(int(state), this);
+    mErrorCallback = cb;
 }
 
-void _Player::onStreamEnd() const
+void _Thumbnailer::onThumbnail(gdouble time, ngw::Frame& frame) const
 {
-    if (mStreamEndCallback != nullptr)
-        mStreamEndCallback(this);
+    // Callee owns the lease, no pixels are copied
+    if (mThumbnailCallback != nullptr)
+        mThumbnailCallback(time, new Frame(std::move(frame)), this);
 }
 
-void _Player::setFrameDirtyFlag(gboolean *flag)
+void _Thumbnailer::onError(const gchar* msg) const
 {
-    mDirtyFlag = flag;
+    if (mErrorCallback != nullptr)
+        mErrorCallback(msg, this);
 }
 
-struct _Discoverer  final : public ngw::Discoverer { };
-
 #ifdef __cplusplus
 extern "C" {
 #endif // __cplusplus
@@ -136,6 +1111,10 @@ NGWAPI const char* ngw_get_version(void) {
     return ngw::getVersion();
 }
 
+NGWAPI long long ngw_get_monotonic_time(void) {
+    return g_get_monotonic_time();
+}
+
 NGWAPI void ngw_add_plugin_path(const char* path) {
     ngw::addPluginPath(path);
 }
@@ -144,6 +1123,46 @@ NGWAPI void ngw_add_binary_path(const char* path) {
     ngw::addBinaryPath(path);
 }
 
+NGWAPI NgwBool ngw_set_element_rank(const char* factory, unsigned rank) {
+    return ngw::setElementRank(factory, rank) ? NGW_BOOL_TRUE : NGW_BOOL_FALSE;
+}
+
+NGWAPI void ngw_set_decoder_thread_budget(unsigned threads, unsigned decoders) {
+    ngw::setDecoderThreadBudget(threads, decoders);
+}
+
+NGWAPI void ngw_set_discovery_cache_enabled(NgwBool on) {
+    ngw::setDiscoveryCacheEnabled(on != NGW_BOOL_FALSE);
+}
+
+NGWAPI void ngw_set_discovery_cache_file(const char* path) {
+    ngw::setDiscoveryCacheFile(path);
+}
+
+NGWAPI void ngw_clear_discovery_cache(void) {
+    ngw::clearDiscoveryCache();
+}
+
+NGWAPI void ngw_set_trace_enabled(NgwBool on) {
+    ngw::setTraceEnabled(on != NGW_BOOL_FALSE);
+}
+
+NGWAPI NgwBool ngw_get_trace_enabled(void) {
+    return ngw::getTraceEnabled() ? NGW_BOOL_TRUE : NGW_BOOL_FALSE;
+}
+
+NGWAPI void ngw_set_trace_gst_latency(NgwBool on) {
+    ngw::setTraceGstLatency(on != NGW_BOOL_FALSE);
+}
+
+NGWAPI NgwBool ngw_dump_trace(const char* path) {
+    return ngw::dumpTrace(path) ? NGW_BOOL_TRUE : NGW_BOOL_FALSE;
+}
+
+NGWAPI void ngw_clear_trace(void) {
+    ngw::clearTrace();
+}
+
 NGWAPI Player* ngw_player_make(void) {
     return new Player();
 }
@@ -152,6 +1171,86 @@ NGWAPI void ngw_player_free(Player* player) {
     delete player;
 }
 
+NGWAPI PlayerGroup* ngw_player_group_make(void) {
+    return new PlayerGroup();
+}
+
+NGWAPI NgwBool ngw_player_group_add(PlayerGroup* group, Player* player) {
+    return group->add(*player) ? NGW_BOOL_TRUE : NGW_BOOL_FALSE;
+}
+
+NGWAPI void ngw_player_group_remove(PlayerGroup* group, Player* player) {
+    group->remove(*player);
+}
+
+NGWAPI unsigned ngw_player_group_get_size(PlayerGroup* group) {
+    return group->getSize();
+}
+
+NGWAPI void ngw_player_group_play(PlayerGroup* group) {
+    group->play();
+}
+
+NGWAPI void ngw_player_group_pause(PlayerGroup* group) {
+    group->pause();
+}
+
+NGWAPI void ngw_player_group_set_time(PlayerGroup* group, double time) {
+    group->setTime(time);
+}
+
+NGWAPI double ngw_player_group_get_time(PlayerGroup* group) {
+    return group->getTime();
+}
+
+NGWAPI double ngw_player_group_get_drift(PlayerGroup* group, Player* player) {
+    return group->getDrift(*player);
+}
+
+NGWAPI void ngw_player_group_free(PlayerGroup* group) {
+    delete group;
+}
+
+NGWAPI PlayerManager* ngw_manager_make(unsigned workers) {
+    return new PlayerManager(workers);
+}
+
+NGWAPI NgwBool ngw_manager_add(PlayerManager* manager, Player* player) {
+    return manager->add(*player) ? NGW_BOOL_TRUE : NGW_BOOL_FALSE;
+}
+
+NGWAPI void ngw_manager_remove(PlayerManager* manager, Player* player) {
+    manager->remove(*player);
+}
+
+NGWAPI unsigned ngw_manager_get_size(PlayerManager* manager) {
+    return manager->getSize();
+}
+
+NGWAPI unsigned ngw_manager_update(PlayerManager* manager, NgwPlayerState* states, unsigned count) {
+    return manager->update(states, count, -1);
+}
+
+NGWAPI unsigned ngw_manager_update_vblank(PlayerManager* manager, NgwPlayerState* states, unsigned count, long long vblank) {
+    return manager->update(states, count, gint64(vblank));
+}
+
+NGWAPI void ngw_manager_free(PlayerManager* manager) {
+    delete manager;
+}
+
+NGWAPI void ngw_manager_set_user_data(PlayerManager* manager, void *data) {
+    manager->setUserData(data);
+}
+
+NGWAPI void* ngw_manager_get_user_data(PlayerManager* manager) {
+    return manager->getUserData();
+}
+
+NGWAPI void ngw_manager_set_process_callback(PlayerManager* manager, NGW_PROCESS_CALLBACK_TYPE cb) {
+    manager->setProcessCallback(cb);
+}
+
 NGWAPI Discoverer* ngw_discoverer_make(void) {
     return new Discoverer();
 }
@@ -168,6 +1267,94 @@ NGWAPI void ngw_discoverer_free(Discoverer* discoverer) {
     delete discoverer;
 }
 
+NGWAPI DiscovererBatch* ngw_discoverer_batch_make(unsigned workers) {
+    return new DiscovererBatch(workers);
+}
+
+NGWAPI NgwBool ngw_discoverer_batch_add(DiscovererBatch* batch, const char* path) {
+    return batch->add(path) ? NGW_BOOL_TRUE : NGW_BOOL_FALSE;
+}
+
+NGWAPI void ngw_discoverer_batch_update(DiscovererBatch* batch) {
+    batch->update();
+}
+
+NGWAPI void ngw_discoverer_batch_wait(DiscovererBatch* batch) {
+    batch->wait();
+}
+
+NGWAPI void ngw_discoverer_batch_cancel(DiscovererBatch* batch) {
+    batch->cancel();
+}
+
+NGWAPI unsigned ngw_discoverer_batch_get_pending(DiscovererBatch* batch) {
+    return batch->getPending();
+}
+
+NGWAPI NgwBool ngw_discoverer_batch_is_done(DiscovererBatch* batch) {
+    return batch->isDone() ? NGW_BOOL_TRUE : NGW_BOOL_FALSE;
+}
+
+NGWAPI void ngw_discoverer_batch_free(DiscovererBatch* batch) {
+    delete batch;
+}
+
+NGWAPI Thumbnailer* ngw_thumbnailer_make(unsigned pipelines) {
+    return new Thumbnailer(pipelines);
+}
+
+NGWAPI NgwBool ngw_thumbnailer_open(Thumbnailer* thumbnailer, const char* path, int width, int height) {
+    return thumbnailer->open(path, width, height) ? NGW_BOOL_TRUE : NGW_BOOL_FALSE;
+}
+
+NGWAPI NgwBool ngw_thumbnailer_open_format(Thumbnailer* thumbnailer, const char* path, int width, int height, const char* fmt) {
+    return thumbnailer->open(path, width, height, fmt) ? NGW_BOOL_TRUE : NGW_BOOL_FALSE;
+}
+
+NGWAPI void ngw_thumbnailer_close(Thumbnailer* thumbnailer) {
+    thumbnailer->close();
+}
+
+NGWAPI NgwBool ngw_thumbnailer_extract(Thumbnailer* thumbnailer, double time) {
+    return thumbnailer->extract(time) ? NGW_BOOL_TRUE : NGW_BOOL_FALSE;
+}
+
+NGWAPI NgwBool ngw_thumbnailer_extract_strip(Thumbnailer* thumbnailer, unsigned count) {
+    return thumbnailer->extractStrip(count) ? NGW_BOOL_TRUE : NGW_BOOL_FALSE;
+}
+
+NGWAPI void ngw_thumbnailer_update(Thumbnailer* thumbnailer) {
+    thumbnailer->update();
+}
+
+NGWAPI void ngw_thumbnailer_wait(Thumbnailer* thumbnailer) {
+    thumbnailer->wait();
+}
+
+NGWAPI void ngw_thumbnailer_cancel(Thumbnailer* thumbnailer) {
+    thumbnailer->cancel();
+}
+
+NGWAPI unsigned ngw_thumbnailer_get_pending(Thumbnailer* thumbnailer) {
+    return thumbnailer->getPending();
+}
+
+NGWAPI NgwBool ngw_thumbnailer_is_done(Thumbnailer* thumbnailer) {
+    return thumbnailer->isDone() ? NGW_BOOL_TRUE : NGW_BOOL_FALSE;
+}
+
+NGWAPI int ngw_thumbnailer_get_width(Thumbnailer* thumbnailer) {
+    return thumbnailer->getWidth();
+}
+
+NGWAPI int ngw_thumbnailer_get_height(Thumbnailer* thumbnailer) {
+    return thumbnailer->getHeight();
+}
+
+NGWAPI void ngw_thumbnailer_free(Thumbnailer* thumbnailer) {
+    delete thumbnailer;
+}
+
 NGWAPI int ngw_discoverer_get_width(Discoverer* discoverer) {
     return discoverer->getWidth();
 }
@@ -220,6 +1407,14 @@ NGWAPI NgwBool ngw_player_open_resize_format(Player* player, const char* path, i
     return player->open(path, width, height, fmt);
 }
 
+NGWAPI NgwBool ngw_player_open_async(Player* player, const char* path) {
+    return player->openAsync(path);
+}
+
+NGWAPI NgwBool ngw_player_open_async_resize_format(Player* player, const char* path, int width, int height, const char* fmt) {
+    return player->openAsync(path, width, height, fmt);
+}
+
 NGWAPI void ngw_player_close(Player* player) {
     player->close();
 }
@@ -250,6 +1445,20 @@ NGWAPI void ngw_player_pause(Player* player) {
 
 NGWAPI void ngw_player_update(Player* player) {
     player->update();
+    player->commitUpload();
+}
+
+NGWAPI void ngw_player_update_vblank(Player* player, long long vblank) {
+    player->update(gint64(vblank));
+    player->commitUpload();
+}
+
+NGWAPI void ngw_player_set_frame_lead(Player* player, double seconds) {
+    player->setFrameLead(seconds);
+}
+
+NGWAPI double ngw_player_get_frame_lead(Player* player) {
+    return player->getFrameLead();
 }
 
 NGWAPI double ngw_player_get_duration(Player* player) {
@@ -264,6 +1473,14 @@ NGWAPI double ngw_player_get_time(Player* player) {
     return player->getTime();
 }
 
+NGWAPI void ngw_player_set_scrubbing(Player* player, NgwBool on) {
+    player->setScrubbing(on != NGW_BOOL_FALSE);
+}
+
+NGWAPI NgwBool ngw_player_get_scrubbing(Player* player) {
+    return player->getScrubbing() ? NGW_BOOL_TRUE : NGW_BOOL_FALSE;
+}
+
 NGWAPI void ngw_player_set_volume(Player* player, double volume) {
     player->setVolume(volume);
 }
@@ -304,6 +1521,147 @@ NGWAPI double ngw_player_get_rate(Player* player) {
     return player->getRate();
 }
 
+NGWAPI void ngw_player_set_frame_queue(Player* player, NgwFrameQueue policy, unsigned depth) {
+    player->setFrameQueue(ngw::FrameQueuePolicy(policy), depth);
+}
+
+NGWAPI NgwFrameQueue ngw_player_get_frame_queue_policy(Player* player) {
+    return NgwFrameQueue(player->getFrameQueuePolicy());
+}
+
+NGWAPI unsigned ngw_player_get_frame_queue_depth(Player* player) {
+    return player->getFrameQueueDepth();
+}
+
+NGWAPI unsigned ngw_player_get_dropped_frames(Player* player, NgwFrameQueue policy) {
+    return player->getDroppedFrames(ngw::FrameQueuePolicy(policy));
+}
+
+NGWAPI void ngw_player_get_stats(Player* player, NgwPlayerStats* stats) {
+    static_assert(int(NGW_FRAME_DROP_REASON_COUNT) == int(ngw::FRAME_DROP_REASON_COUNT), "Drop reason count mismatch.");
+    const ngw::PlayerStats src = player->getStats();
+
+    stats->frames_received      = src.framesReceived;
+    stats->frames_delivered     = src.framesDelivered;
+    stats->average_latency      = src.averageLatency;
+    stats->max_latency          = src.maxLatency;
+    stats->average_frame_time   = src.averageFrameTime;
+    stats->max_frame_time       = src.maxFrameTime;
+    stats->seeks                = src.seeks;
+    stats->average_seek_latency = src.averageSeekLatency;
+    stats->max_seek_latency     = src.maxSeekLatency;
+    stats->bus_messages         = src.busMessages;
+    stats->bytes_copied         = src.bytesCopied;
+
+    for (guint reason = 0; reason < NGW_FRAME_DROP_REASON_COUNT; ++reason)
+        stats->frames_dropped[reason] = src.framesDropped[reason];
+}
+
+NGWAPI void ngw_player_set_reuse_pipeline(Player* player, NgwBool on) {
+    player->setReusePipeline(on != NGW_BOOL_FALSE);
+}
+
+NGWAPI NgwBool ngw_player_get_reuse_pipeline(Player* player) {
+    return player->getReusePipeline() ? NGW_BOOL_TRUE : NGW_BOOL_FALSE;
+}
+
+NGWAPI void ngw_player_set_bus_thread(Player* player, NgwBool on) {
+    player->setBusThread(on != NGW_BOOL_FALSE);
+}
+
+NGWAPI NgwBool ngw_player_get_bus_thread(Player* player) {
+    return player->getBusThread() ? NGW_BOOL_TRUE : NGW_BOOL_FALSE;
+}
+
+NGWAPI void ngw_player_set_sync(Player* player, NgwBool on) {
+    player->setSync(on != NGW_BOOL_FALSE);
+}
+
+NGWAPI void ngw_player_set_padded_frames(Player* player, NgwBool on) {
+    player->setPaddedFrames(on != NGW_BOOL_FALSE);
+}
+
+NGWAPI NgwBool ngw_player_get_padded_frames(Player* player) {
+    return player->getPaddedFrames() ? NGW_BOOL_TRUE : NGW_BOOL_FALSE;
+}
+
+NGWAPI NgwBool ngw_player_get_sync(Player* player) {
+    return player->getSync() ? NGW_BOOL_TRUE : NGW_BOOL_FALSE;
+}
+
+NGWAPI void ngw_player_set_decoder_property(Player* player, const char* name, const char* value) {
+    player->setDecoderProperty(name, value);
+}
+
+NGWAPI void ngw_player_set_decoder_threads(Player* player, unsigned threads) {
+    player->setDecoderThreads(threads);
+}
+
+NGWAPI unsigned ngw_player_get_decoder_threads(Player* player) {
+    return player->getDecoderThreads();
+}
+
+NGWAPI void ngw_player_set_convert_options(Player* player, const NgwConvertOptions* options) {
+    ngw::ConvertOptions dst;
+    dst.threads = options->threads;
+    dst.scale   = ngw::ScaleMethod(options->scale);
+    dst.dither  = ngw::DitherMethod(options->dither);
+    player->setConvertOptions(dst);
+}
+
+NGWAPI void ngw_player_set_audio_tap(Player* player, const char* format, int rate, int channels, unsigned latency) {
+    player->setAudioTap(format, rate, channels, latency);
+}
+
+NGWAPI NgwBool ngw_player_get_audio_tap(Player* player) {
+    return player->getAudioTap() ? NGW_BOOL_TRUE : NGW_BOOL_FALSE;
+}
+
+NGWAPI size_t ngw_player_read_audio(Player* player, void* dst, size_t size) {
+    return player->readAudio(static_cast<guchar*>(dst), size);
+}
+
+NGWAPI size_t ngw_player_get_audio_available(Player* player) {
+    return player->getAudioAvailable();
+}
+
+NGWAPI void ngw_player_set_crop(Player* player, int left, int top, int right, int bottom) {
+    player->setCrop(left, top, right, bottom);
+}
+
+NGWAPI void ngw_player_get_crop(Player* player, int* left, int* top, int* right, int* bottom) {
+    gint crop[4];
+    player->getCrop(crop[0], crop[1], crop[2], crop[3]);
+
+    if (left != nullptr)    *left   = crop[0];
+    if (top != nullptr)     *top    = crop[1];
+    if (right != nullptr)   *right  = crop[2];
+    if (bottom != nullptr)  *bottom = crop[3];
+}
+
+NGWAPI void ngw_player_get_convert_options(Player* player, NgwConvertOptions* options) {
+    const ngw::ConvertOptions& src = player->getConvertOptions();
+    options->threads    = src.threads;
+    options->scale      = NgwScaleMethod(src.scale);
+    options->dither     = NgwDitherMethod(src.dither);
+}
+
+NGWAPI NgwBool ngw_player_enqueue(Player* player, const char* path) {
+    return player->enqueue(path) ? NGW_BOOL_TRUE : NGW_BOOL_FALSE;
+}
+
+NGWAPI void ngw_player_clear_queue(Player* player) {
+    player->clearQueue();
+}
+
+NGWAPI unsigned ngw_player_get_queue_length(Player* player) {
+    return player->getQueueLength();
+}
+
+NGWAPI const char* ngw_player_get_uri(Player* player) {
+    return player->getUri();
+}
+
 NGWAPI void ngw_player_set_user_data(Player* player, void *data) {
     player->setUserData(data);
 }
@@ -316,6 +1674,33 @@ NGWAPI void ngw_player_set_frame_buffer(Player* player, void *buffer, NgwBuffer
     player->setFrameBuffer(buffer, type);
 }
 
+NGWAPI void ngw_player_set_frame_buffer_size(Player* player, size_t size) {
+    player->setFrameBufferSize(size);
+}
+
+NGWAPI void ngw_player_set_frame_pool(Player* player, unsigned char* const* buffers, unsigned count, size_t size) {
+    player->setFramePool(buffers, count, size);
+}
+
+NGWAPI int ngw_player_get_frame_pool_index(Player* player) {
+    return player->getPoolIndex();
+}
+
+NGWAPI void ngw_player_set_triple_buffer(Player* player, unsigned char* const* buffers, size_t size) {
+    player->setTripleBuffer(buffers, size);
+}
+
+NGWAPI const unsigned char* ngw_player_acquire_latest(Player* player, unsigned long long* sequence) {
+    guint64 frame_sequence = 0;
+    const guchar* buffer = player->acquireLatest(&frame_sequence);
+    if (sequence != nullptr) *sequence = frame_sequence;
+    return buffer;
+}
+
+NGWAPI void ngw_player_release_latest(Player* player) {
+    player->releaseLatest();
+}
+
 NGWAPI void ngw_player_set_frame_dirty_flag(Player* player, NgwBool *flag) {
     player->setFrameDirtyFlag(flag);
 }
@@ -332,6 +1717,88 @@ NGWAPI void ngw_player_set_stream_end_callback(Player* player, NGW_STREAM_END_CA
     player->setStreamEndCallback(cb);
 }
 
+NGWAPI void ngw_player_set_frame_info_callback(Player* player, NGW_FRAME_INFO_CALLBACK_TYPE cb) {
+    player->setFrameInfoCallback(cb);
+}
+
+NGWAPI void ngw_player_set_seeked_callback(Player* player, NGW_SEEKED_CALLBACK_TYPE cb) {
+    player->setSeekedCallback(cb);
+}
+
+NGWAPI void ngw_player_set_opened_callback(Player* player, NGW_OPENED_CALLBACK_TYPE cb) {
+    player->setOpenedCallback(cb);
+}
+
+NGWAPI void ngw_player_set_track_changed_callback(Player* player, NGW_TRACK_CHANGED_CALLBACK_TYPE cb) {
+    player->setTrackChangedCallback(cb);
+}
+
+NGWAPI double ngw_player_get_upload_time(Player* player) {
+    return player->getUploadTime();
+}
+
+NGWAPI double ngw_player_get_upload_copy_time(Player* player) {
+    return player->getUploadCopyTime();
+}
+
+NGWAPI Frame* ngw_player_lease_frame(Player* player) {
+    return player->leaseFrame();
+}
+
+NGWAPI NgwBool ngw_player_get_frame_layout(Player* player, NgwFrameLayout* layout) {
+    return player->getFrameLayout(layout);
+}
+
+NGWAPI unsigned char* ngw_frame_get_data(Frame* frame) {
+    return frame->getData();
+}
+
+NGWAPI unsigned ngw_frame_get_size(Frame* frame) {
+    return static_cast<unsigned int>(frame->getSize());
+}
+
+NGWAPI NgwBool ngw_frame_get_layout(Frame* frame, NgwFrameLayout* layout) {
+    ngw::FrameLayout frame_layout;
+    bool success = frame->getLayout(frame_layout);
+    return toNgwLayout(frame_layout, layout, success);
+}
+
+NGWAPI void ngw_frame_get_info(Frame* frame, NgwFrameInfo* info) {
+    toNgwInfo(frame->getInfo(), info);
+}
+
+NGWAPI void ngw_frame_release(Frame* frame) {
+    delete frame;
+}
+
+NGWAPI void ngw_discoverer_batch_set_user_data(DiscovererBatch* batch, void *data) {
+    batch->setUserData(data);
+}
+
+NGWAPI void* ngw_discoverer_batch_get_user_data(DiscovererBatch* batch) {
+    return batch->getUserData();
+}
+
+NGWAPI void ngw_discoverer_batch_set_discovered_callback(DiscovererBatch* batch, NGW_DISCOVERED_CALLBACK_TYPE cb) {
+    batch->setDiscoveredCallback(cb);
+}
+
+NGWAPI void ngw_thumbnailer_set_user_data(Thumbnailer* thumbnailer, void *data) {
+    thumbnailer->setUserData(data);
+}
+
+NGWAPI void* ngw_thumbnailer_get_user_data(Thumbnailer* thumbnailer) {
+    return thumbnailer->getUserData();
+}
+
+NGWAPI void ngw_thumbnailer_set_thumbnail_callback(Thumbnailer* thumbnailer, NGW_THUMBNAIL_CALLBACK_TYPE cb) {
+    thumbnailer->setThumbnailCallback(cb);
+}
+
+NGWAPI void ngw_thumbnailer_set_error_callback(Thumbnailer* thumbnailer, NGW_THUMBNAILER_ERROR_CALLBACK_TYPE cb) {
+    thumbnailer->setErrorCallback(cb);
+}
+
 #ifdef __cplusplus
 } // extern "C"
 #endif // __cplusplus
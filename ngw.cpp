@@ -2,7 +2,11 @@
 
 #include <gst/gstregistry.h>
 #include <gst/app/gstappsink.h>
+#include <gst/audio/audio.h>
+#include <gst/video/video.h>
 #include <gst/pbutils/gstdiscoverer.h>
+#include <glib/gstdio.h>
+#include <cstring>
 
 namespace ngw
 {
@@ -17,7 +21,8 @@ struct BindToScope
 
 template<> BindToScope<gchar>::~BindToScope()                   { g_free(pointer); pointer = nullptr; }
 template<> BindToScope<GList>::~BindToScope()                   { gst_discoverer_stream_info_list_free(pointer); pointer = nullptr; }
-template<> BindToScope<GError>::~BindToScope()                  { g_error_free(pointer); pointer = nullptr; }
+template<> BindToScope<GError>::~BindToScope()                  { if (pointer) g_error_free(pointer); pointer = nullptr; }
+template<> BindToScope<GKeyFile>::~BindToScope()                { if (pointer) g_key_file_free(pointer); pointer = nullptr; }
 template<> BindToScope<GstMessage>::~BindToScope()              { gst_message_unref(pointer); pointer = nullptr; }
 template<> BindToScope<GstAppSink>::~BindToScope()              { g_object_unref(pointer); pointer = nullptr; }
 template<> BindToScope<GstDiscoverer>::~BindToScope()           { g_object_unref(pointer); pointer = nullptr; }
@@ -29,6 +34,279 @@ template< class T > struct no_ptr<T*>    { typedef T type; };
 #define BIND_TO_SCOPE(var) BindToScope<\
     no_ptr<decltype(var)>::type> scoped_##var(var);
 #define DISCOVER_TIMEOUT (10 * GST_SECOND)
+#define MAX_FRAME_QUEUE_DEPTH 16
+#define GROUP_START_DELAY (100 * GST_MSECOND)
+#define TRACE_RING_SIZE 8192
+#define AUDIO_SINK_NAME "ngwaudiosink"
+
+//! Fixed capacity single producer (streaming thread), single consumer (update) queue of samples
+class FrameQueue
+{
+public:
+    FrameQueue(FrameQueuePolicy policy, guint depth, volatile gint* dropped, PlayerCounters* counters);
+    ~FrameQueue();
+    //! producer side. takes ownership of the frame
+    void            push(Frame* frame);
+    //! consumer side. returns the next frame (owned by the caller) or nullptr if queue is empty
+    Frame*          pop();
+    //! consumer side. returns the latest frame due by time (monotonic, micro seconds), skipping older ones.
+    //! First frame not due yet is held for a later call. nullptr if no frame is due
+    Frame*          popDue(gint64 time);
+    //! while flushing, a blocked producer drops its frame and returns
+    void            setFlushing(bool on);
+
+private:
+    void            drop(Frame* frame);
+
+    FrameQueuePolicy mPolicy;
+    guint           mCapacity;              //!< Number of slots in the ring (depth + 1)
+    Frame           **mSlots;                  //!< Ring storage, FRAME_QUEUE_FIFO and FRAME_QUEUE_BLOCK
+    volatile gint   mHead       = 0;        //!< Next slot to write, only written by producer
+    volatile gint   mTail       = 0;        //!< Next slot to read, only written by consumer
+    gpointer        mMailbox    = nullptr;  //!< Pending frame, FRAME_QUEUE_LATEST
+    Frame           *mHeld      = nullptr;  //!< Frame popped ahead of its due time, only touched by consumer
+    volatile gint   mFlushing   = FALSE;    //!< Atomic boolean, unblocks producer
+    volatile gint   *mDropped;              //!< Drop counter of the owning player for this policy
+    PlayerCounters  *mCounters;             //!< Lifetime counters of the owning player, bumps FRAME_DROP_QUEUE
+    GMutex          mLock;                  //!< Guards waiting of a blocked producer
+    GCond           mCond;                  //!< Signaled when a slot frees up or on flush
+};
+
+//! Process-wide cache of discovered media, keyed by URI and validated by file size and modification time
+class DiscoveryCache
+{
+public:
+    static DiscoveryCache& get();
+    //! fills discoverer from the cache. false on a miss
+    bool            lookup(const gchar* uri, Discoverer& discoverer);
+    //! adds or replaces the entry of a successfully discovered media. Without persist, file is written by flush()
+    void            store(const Discoverer& discoverer, bool persist = true);
+    //! writes entries stored without persisting into the cache file
+    void            flush();
+    void            setEnabled(bool on);
+    void            setFile(const gchar* path);
+    void            clear();
+
+private:
+    struct Entry
+    {
+        Discoverer  discoverer;
+        gint64      size    = 0;
+        gint64      mtime   = 0;            //!< Micro seconds, files rewritten within a second still differ
+    };
+
+    DiscoveryCache();
+    static bool     stat(const gchar* uri, gint64& size, gint64& mtime);
+    static void     freeEntry(gpointer entry);
+    void            load();
+    //! writes the entries into mFile if they changed. Takes mLock only to snapshot them, MUST be called without it
+    void            save();
+
+    GMutex          mLock;
+    GMutex          mSaveLock;              //!< Serializes writes of mFile, never held together with mLock
+    GHashTable      *mEntries;              //!< URI => Entry
+    gchar           *mFile      = nullptr;  //!< Persistence file, nullptr if not persisted
+    guint64         mGeneration = 0;        //!< Snapshots taken by save()
+    guint64         mSaved      = 0;        //!< Snapshot last written to mFile, older ones are dropped
+    bool            mEnabled    = true;
+    bool            mDirty      = false;    //!< Entries stored but not written to mFile yet
+};
+
+//! Process-wide split of video decoder threads between players, set by setDecoderThreadBudget(...)
+class DecoderPolicy
+{
+public:
+    static DecoderPolicy& get();
+    void            setBudget(guint threads, guint decoders);
+    //! answers threads granted to a newly created decoder, 0 if uncapped. Must be paired with release(...) of the grant
+    guint           acquire();
+    void            release(guint threads);
+
+private:
+    DecoderPolicy();
+
+    GMutex          mLock;
+    guint           mThreads    = 0;        //!< Total threads of all video decoders, 0 if uncapped
+    guint           mDecoders   = 1;        //!< Video decoders expected at the same time
+    guint           mLive       = 0;        //!< Video decoders holding a grant
+    guint           mUsed       = 0;        //!< Threads granted to live decoders
+};
+
+//! Process-wide recorder of spans and events. Each thread writes its own ring, dump() merges them into Chrome trace JSON
+class Tracer
+{
+public:
+    static Tracer&  get();
+    //! a single atomic read, call sites check it before taking any time stamp
+    static bool     isEnabled() { return g_atomic_int_get(&sEnabled) != FALSE; }
+    void            setEnabled(bool on);
+    void            setGstLatency(bool on);
+    //! records a span ('X'), an instant ('i') or a counter ('C') on the ring of the calling thread. name must outlive the tracer
+    void            record(const gchar* name, gchar phase, gint64 start, gint64 duration = 0, gint64 value = 0);
+    bool            dump(const gchar* path);
+    void            clear();
+
+private:
+    struct Event
+    {
+        const gchar *name;                  //!< Static or interned string
+        gint64      start;                  //!< Monotonic time, micro seconds
+        gint64      duration;
+        gint64      value;                  //!< Value of a counter, nanoseconds for latency records
+        guint       thread;                 //!< Trace id of the recording thread
+        gchar       phase;
+    };
+
+    struct Ring
+    {
+        Event           events[TRACE_RING_SIZE];
+        volatile gint   head    = 0;        //!< Events ever written, only written by the owning thread
+        volatile gint   floor   = 0;        //!< Events before this were cleared
+        guint           thread  = 0;        //!< Trace id of the current owner
+    };
+
+    Tracer();
+    Ring*           acquire();
+    static void     releaseRing(gpointer ring);
+    //! appends text as a JSON string body, g_strescape's octal escapes are not JSON. UTF-8 passes through
+    static void     appendJson(GString* json, const gchar* text);
+    static void     onGstLog(GstDebugCategory* category, GstDebugLevel level, const gchar* file, const gchar* function,
+                             gint line, GObject* object, GstDebugMessage* message, gpointer);
+
+    static volatile gint sEnabled;
+    static GPrivate sRing;
+    GMutex          mLock;                  //!< Guards ring bookkeeping, never taken by record() once a thread has its ring
+    GPtrArray       *mRings;                //!< Every ring ever created
+    GSList          *mFreeRings = nullptr;  //!< Rings of exited threads, reused by new ones
+    guint           mThreads    = 0;        //!< Last trace id handed to a thread
+    bool            mGstLatency = false;
+};
+
+//! Records a span from construction to the end of the scope, if tracing was on at construction
+class TraceScope
+{
+public:
+    explicit TraceScope(const gchar* name) : mName(name), mStart(Tracer::isEnabled() ? g_get_monotonic_time() : -1) {}
+    ~TraceScope() { if (mStart >= 0) Tracer::get().record(mName, 'X', mStart, g_get_monotonic_time() - mStart); }
+
+private:
+    const gchar     *mName;
+    gint64          mStart;                 //!< -1 if tracing was off
+};
+
+#define TRACE_SCOPE(name) TraceScope G_PASTE(trace_scope_, __LINE__)(name)
+
+//! Counters behind Player::getStats(). Locked ones are bumped by the streaming and bus threads, rest by update()
+struct PlayerCounters
+{
+    PlayerCounters()    { g_mutex_init(&lock); }
+    ~PlayerCounters()   { g_mutex_clear(&lock); }
+    //! bumps a locked counter. 64 bits never wrap over the lifetime of a player, GLib has no 64-bit atomics
+    void            add(guint64& counter)               { g_mutex_lock(&lock); ++counter; g_mutex_unlock(&lock); }
+    guint64         get(const guint64& counter) const   { g_mutex_lock(&lock); const guint64 value = counter; g_mutex_unlock(&lock); return value; }
+
+    mutable GMutex  lock;                   //!< Guards received, dropped and messages
+    guint64         received    = 0;
+    guint64         dropped[FRAME_DROP_REASON_COUNT] = {};
+    guint64         messages    = 0;
+    guint64         delivered   = 0;
+    gint64          latency     = 0;        //!< Accumulated, micro seconds
+    gint64          maxLatency  = 0;
+    gint64          frameTime   = 0;        //!< Accumulated, micro seconds
+    gint64          maxFrameTime = 0;
+    guint64         seeks       = 0;
+    gint64          seekLatency = 0;        //!< Accumulated, micro seconds
+    gint64          maxSeekLatency = 0;
+    guint64         bytesCopied = 0;
+};
+
+//! Buffer pool over memory registered by Player::setFramePool(...), offered upstream through the video sink's allocation query
+struct FramePool
+{
+    GstBufferPool   parent;
+    GMutex          lock;                   //!< Guards used
+    guchar          **buffers;              //!< Caller owned
+    gboolean        *used;                  //!< Buffers wrapped by a live GstBuffer
+    guint           count;
+    gsize           size;                   //!< Bytes of each buffer
+};
+
+struct FramePoolClass
+{
+    GstBufferPoolClass parent;
+};
+
+//! Single producer (audio sink's streaming thread) single consumer (Player::readAudio(...)) ring of PCM bytes
+struct AudioRing
+{
+    AudioRing(guint size, guint bpf);
+    ~AudioRing();
+    //! copies whole sample frames of data in, answers bytes that did not fit. Producer ONLY
+    gsize           push(const guint8* data, gsize size);
+    //! copies whole sample frames out into dst, answers bytes copied. Consumer ONLY
+    gsize           pull(guint8* dst, gsize size);
+    //! answers bytes pull(...) can copy. Consumer ONLY
+    gsize           available() const;
+    //! makes the next pull(...) drop everything pushed so far, keeping what is pushed after. Any thread
+    void            flush();
+
+    guint8          *data;
+    const guint     size;                   //!< Bytes of data, MUST be a power of two so positions can wrap around
+    const guint     bpf;                    //!< Bytes per sample frame
+    volatile gint   written;                //!< Bytes pushed so far (wrapping), stored by the producer
+    volatile gint   read;                   //!< Bytes pulled so far (wrapping), stored by the consumer
+    volatile gint   flushing;               //!< Set by flush(), cleared by the consumer
+    volatile gint   flushed;                //!< Value of written when flush() was last called, the consumer skips to it
+};
+
+//! A media probed by a DiscovererBatch worker, waiting to be delivered by DiscovererBatch::update()
+struct DiscoveryTask
+{
+    Discoverer      discoverer;
+    bool            success = false;
+    bool            done    = false;        //!< Set once the worker's GstDiscoverer is finished with the media
+};
+
+//! Discovery of a Player::openAsync(...) call. Shared between the player and a worker of Internal::openPool()
+struct OpenTask
+{
+    gchar           *path       = nullptr;
+    gchar           *format     = nullptr;
+    gint            width       = 0;        //!< Requested width, 0 to use the discovered one
+    gint            height      = 0;        //!< Requested height, 0 to use the discovered one
+    Discoverer      discoverer;
+    bool            success     = false;
+    volatile gint   done        = FALSE;    //!< Atomic boolean, set once discovery is finished
+    volatile gint   canceled    = FALSE;    //!< Atomic boolean, set if player no longer waits for this task
+    volatile gint   refs        = 2;        //!< Held by the player and by the worker
+};
+
+//! Compact bus message, parsed off the bus by Internal::parse(...) and handled by Player::update()
+struct BusEvent
+{
+    ~BusEvent() { g_free(error); }
+
+    BusEvent        *next       = nullptr;  //!< Older event, BusEvent lists are built newest first
+    GstMessageType  type        = GST_MESSAGE_UNKNOWN;
+    GstState        oldState    = GST_STATE_VOID_PENDING;
+    GstState        newState    = GST_STATE_VOID_PENDING;
+    gdouble         duration    = -1.;      //!< Queried while parsing, negative if unknown
+    gchar           *error      = nullptr;  //!< Message of GST_MESSAGE_ERROR
+};
+
+//! A frame requested from a Thumbnailer, extracted by one of its pipeline threads
+struct ThumbnailTask
+{
+    gdouble         time    = 0.;
+    Frame           frame;                  //!< Not valid if extraction failed
+};
+
+//! A frame delivered by PlayerManager::update(...), processed by one of its workers
+struct ProcessTask
+{
+    const Player    *player = nullptr;
+    Frame           *frame  = nullptr;      //!< Owned by the task
+};
 
 class Internal
 {
@@ -37,17 +315,90 @@ public:
     static gchar*          processPath(const gchar* path);
     static void            reset(Player& player);
     static void            reset(Discoverer& discoverer);
+    static void            reset(Frame& frame);
+    static void            copy(Discoverer& dst, const Discoverer& src);
+    static void            load(Discoverer& discoverer, GKeyFile* key_file, const gchar* uri);
+    static void            save(const Discoverer& discoverer, GKeyFile* key_file, const gchar* uri);
+    static bool            fill(Discoverer& discoverer, GstDiscovererInfo* info);
     static bool            gstreamerInitialized();
     static GstFlowReturn   onPreroll(GstElement* appsink, Player* player);
     static GstFlowReturn   onSampled(GstElement* appsink, Player* player);
-    static void            processSample(Player *const player, GstSample* const sample);
+    static GstFlowReturn   onAudioSampled(GstElement* appsink, Player* player);
+    static GstPadProbeReturn onAudioFlush(GstPad* pad, GstPadProbeInfo* info, gpointer player);
+    static void            freeAudioRing(gpointer ring);
+    static void            processSample(Player *const player, GstSample* const sample, GstElement* const sink);
+    static bool            mapSample(Frame& frame, GstSample* sample);
+    static void            describe(Player& player, Frame& frame, GstElement* sink);
+    static void            copyInfo(Frame& dst, const Frame& src);
+    static bool            layout(const Frame& frame, FrameLayout& layout);
+    static GstPadProbeReturn onSinkQuery(GstPad* pad, GstPadProbeInfo* info, gpointer player);
+    static GType           framePoolType();
+    static GQuark          framePoolQuark();
+    static void            initFramePoolClass(gpointer klass, gpointer);
+    static void            initFramePool(GTypeInstance* instance, gpointer);
+    static void            finalizeFramePool(GObject* object);
+    static GstFlowReturn   allocFrameBuffer(GstBufferPool* pool, GstBuffer** buffer, GstBufferPoolAcquireParams*);
+    static void            freeFrameBuffer(GstBufferPool* pool, GstBuffer* buffer);
+    static GstBufferPool*  newFramePool(const Player& player);
     static void            processDuration(Player& player);
+    static gdouble         queryDuration(GstElement* pipeline);
+    static bool            parse(const Player& player, GstMessage* msg, BusEvent& event);
+    static bool            isVideoElement(GstObject* object);
+    static bool            dispatch(Player& player, const BusEvent& event);
+    static GMainContext*   busContext();
+    static gpointer        watchBuses(gpointer context);
+    static void            watchBus(Player& player, bool on);
+    static gboolean        onBusMessage(GstBus* bus, GstMessage* msg, Player* player);
+    static BusEvent*       takeEvents(Player& player);
+    static void            clearEvents(Player& player);
+    static void            processEvents(Player& player);
+    static Frame*          present(Player& player, gint64 vblank);
+    static void            snapshot(const Player& player, PlayerState& state, const Frame* frame);
+    static bool            isManaged(const PlayerManager& manager, const Player* player);
+    static void            processFrame(gpointer task, gpointer manager);
+    static void            onElementSetup(GstElement* playbin, GstElement* element, Player* player);
+    static void            setupConverter(GstElement* element, const ConvertOptions& options);
+    static void            setEnumProperty(GstElement* element, const gchar* name, const gchar* value);
+    static void            releaseDecoder(gpointer threads, GObject*);
+    static gchar*          videoCaps(gint width, gint height, const gchar* fmt);
+    static bool            buildPipeline(Player& player, const Discoverer& discoverer, gint width, gint height, const gchar* fmt);
+    static bool            reusePipeline(Player& player, const Discoverer& discoverer, gint width, gint height, const gchar* fmt);
+    static void            releasePipeline(Player& player);
+    static void            applyCrop(const Player& player, GstElement* crop);
+    static void            onAboutToFinish(GstElement* playbin, Player* player);
+    static void            processTrackChange(Player& player);
+    static void            clearPlaylist(Player& player);
+    static bool            preparePipeline(Player& player, const Discoverer& discoverer, gint width, gint height, const gchar* fmt);
+    static bool            open(Player& player, const gchar* path, gint width, gint height, const gchar* fmt);
+    static GThreadPool*    openPool();
+    static void            discoverOpen(gpointer task, gpointer);
+    static void            processOpen(Player& player);
+    static void            cancelOpen(Player& player);
+    static void            unref(OpenTask* task);
+    static gpointer        discoverMedia(gpointer batch);
+    static void            onDiscovered(GstDiscoverer* discoverer, GstDiscovererInfo* info, GError* error, DiscoveryTask** task);
+    static void            processDiscovery(DiscovererBatch& batch, gpointer task);
+    static gpointer        extractThumbnails(gpointer thumbnailer);
+    static void            slave(PlayerGroup& group, Player& player);
+    static void            unslave(Player& player);
+    static bool            isOpen(const Player& player);
+    static void            start(Player& player, GstClockTime base_time);
+    static void            seek(Player& player, gdouble time);
+    static void            preroll(Player& player);
+    static void            processThumbnail(Thumbnailer& thumbnailer, gpointer task);
 };
 
 Player::Player()
     : mLoop(false)
     , mMute(false)
 {
+    g_queue_init(&mPlaylist);
+    g_mutex_init(&mPlaylistLock);
+    g_mutex_init(&mBusLock);
+    mCounters = new PlayerCounters();
+    mDecoderProps = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    mDecoderSetup = nullptr;
+
     Internal::reset(*this);
     if (!Internal::gstreamerInitialized())
     {
@@ -57,7 +408,17 @@ Player::Player()
 
 Player::~Player()
 {
+    mReusePipeline = false;
     close();
+    g_mutex_clear(&mPlaylistLock);
+    g_mutex_clear(&mBusLock);
+    g_hash_table_destroy(mDecoderProps);
+    g_free(mPoolBuffers);
+    g_free(mAudioCaps);
+    delete mAudioRing;
+    g_slist_free_full(mRetiredAudioRings, &Internal::freeAudioRing);
+    delete mCounters;
+    if (mDecoderSetup != nullptr) g_hash_table_destroy(mDecoderSetup);
 }
 
 const gchar* getVersion()
@@ -93,6 +454,78 @@ void addPluginPath(const gchar* path)
     }
 }
 
+bool setElementRank(const gchar* factory, guint rank)
+{
+    if (Internal::isNullOrEmpty(factory))
+    {
+        g_debug("Element factory supplied is empty.");
+        return false;
+    }
+
+    if (!Internal::gstreamerInitialized())
+    {
+        g_debug("You are not able to set element rank. %s",
+                "GStreamer could not be initialized.");
+        return false;
+    }
+
+    GstPluginFeature *feature = gst_registry_lookup_feature(gst_registry_get(), factory);
+    if (feature == nullptr)
+    {
+        g_debug("Element factory %s is not registered.", factory);
+        return false;
+    }
+
+    gst_plugin_feature_set_rank(feature, rank);
+    gst_object_unref(feature);
+    return true;
+}
+
+void setDecoderThreadBudget(guint threads, guint decoders)
+{
+    DecoderPolicy::get().setBudget(threads, decoders);
+}
+
+void setDiscoveryCacheEnabled(bool on)
+{
+    DiscoveryCache::get().setEnabled(on);
+}
+
+void setDiscoveryCacheFile(const gchar* path)
+{
+    DiscoveryCache::get().setFile(path);
+}
+
+void clearDiscoveryCache()
+{
+    DiscoveryCache::get().clear();
+}
+
+void setTraceEnabled(bool on)
+{
+    Tracer::get().setEnabled(on);
+}
+
+bool getTraceEnabled()
+{
+    return Tracer::isEnabled();
+}
+
+void setTraceGstLatency(bool on)
+{
+    Tracer::get().setGstLatency(on);
+}
+
+bool dumpTrace(const gchar* path)
+{
+    return Tracer::get().dump(path);
+}
+
+void clearTrace()
+{
+    Tracer::get().clear();
+}
+
 void addBinaryPath(const gchar* path)
 {
     if (Internal::isNullOrEmpty(path))
@@ -121,162 +554,154 @@ void addBinaryPath(const gchar* path)
 
 bool Player::open(const gchar *path, gint width, gint height, const gchar* fmt)
 {
-    bool success = false;
+    return Internal::open(*this, path, width, height, fmt);
+}
+
+bool Player::openAsync(const gchar *path, gint width, gint height, const gchar* fmt)
+{
     if (!Internal::gstreamerInitialized())
     {
         onError("You cannot open a media with ngw.");
-        return success;
+        return false;
     }
 
-    // First close any current streams.
+    // First close any current streams (and pending opens).
     close();
 
     if (Internal::isNullOrEmpty(path))
     {
         onError("Supplied media path is empty.");
-        return success;
+        return false;
     }
 
-    Discoverer discoverer;
-    if (discoverer.open(path))
-    {
-        gchar* pipeline_cmd = nullptr;
-        BIND_TO_SCOPE(pipeline_cmd);
-
-        if (discoverer.getHasVideo())
-        {
-            // Create the pipeline expression
-            pipeline_cmd = g_strdup_printf(
-                "playbin uri=\"%s\" video-sink=\""
-                "appsink drop=yes async=no qos=yes sync=yes max-lateness=%lld "
-                "caps=video/x-raw,width=%d,height=%d,format=%s\"",
-                discoverer.getUri(),
-                static_cast<long long>(GST_SECOND),
-                width,
-                height,
-                Internal::isNullOrEmpty(fmt) ? "BGRA" : fmt);
-        }
-        else if (discoverer.getHasAudio())
-        {
-            // Create the pipeline expression
-            pipeline_cmd = g_strdup_printf(
-                "playbin uri=\"%s\"",
-                discoverer.getUri());
-        }
-        else
-        {
-            onError("Media provided does not contain neither audio nor video.");
-            return success;
-        }
-
-        if (!Internal::isNullOrEmpty(scoped_pipeline_cmd.pointer))
-        {
-            mPipeline = gst_parse_launch(scoped_pipeline_cmd.pointer, nullptr);
-            if (mPipeline == nullptr)
-            {
-                close();
-                onError("Unable to launch the pipeline.");
-                return success;
-            }
+    OpenTask* task  = new OpenTask();
+    task->path      = g_strdup(path);
+    task->format    = g_strdup(Internal::isNullOrEmpty(fmt) ? "BGRA" : fmt);
+    task->width     = width;
+    task->height    = height;
 
-            mGstBus = gst_pipeline_get_bus(GST_PIPELINE(mPipeline));
-            if (mGstBus == nullptr)
-            {
-                close();
-                onError("Unable to obtain pipeline's bus.");
-                return success;
-            }
+    mOpenTask = task;
+    g_thread_pool_push(Internal::openPool(), task, nullptr);
+    return true;
+}
 
-            if (discoverer.getHasVideo())
-            {
-                GstAppSink *app_sink = nullptr;
-                BIND_TO_SCOPE(app_sink);
+bool Player::openAsync(const gchar *path)
+{
+    return openAsync(path, 0, 0, "BGRA");
+}
 
-                g_object_get(mPipeline, "video-sink", &app_sink, nullptr);
-                if (app_sink == nullptr)
-                {
-                    close();
-                    onError("Unable to obtain pipeline's video sink.");
-                    return success;
-                }
+bool Player::open(const gchar *path, gint width, gint height)
+{
+    return Internal::open(*this, path, width, height, "BGRA");
+}
 
-                // Configure VideoSink's appsink:
-                typedef GstFlowReturn(*APP_SINK_CB) (GstAppSink*, gpointer);
-                GstAppSinkCallbacks callbacks;
+bool Player::open(const gchar *path, const gchar* fmt)
+{
+    return Internal::open(*this, path, 0, 0, fmt);
+}
 
-                callbacks.eos           = nullptr;
-                callbacks.new_preroll   = APP_SINK_CB(&Internal::onPreroll);
-                callbacks.new_sample    = APP_SINK_CB(&Internal::onSampled);
+bool Player::open(const gchar *path)
+{
+    return Internal::open(*this, path, 0, 0, "BGRA");
+}
 
-                gst_app_sink_set_callbacks(scoped_app_sink.pointer, &callbacks, this, nullptr);
-            }
+void Player::close()
+{
+    Internal::cancelOpen(*this);
 
-            // Going from NULL => READY => PAUSE forces the
-            // pipeline to pre-roll so we can get video dim
-            GstState state;
+    if (mReusePipeline && mPipeline != nullptr)
+    {
+        // Keep the play-bin (and its loaded plug-ins) around for the next open(...)
+        GstElement *pipeline    = mPipeline;
+        GstBus *bus             = mGstBus;
+        GSource *watch          = mBusWatch;
+
+        setState(GST_STATE_READY);
+        if (mFrameQueue != nullptr) delete mFrameQueue;
+        if (mBufferPool != nullptr) gst_object_unref(mBufferPool);
+        if (mAudioRing != nullptr)  mAudioRing->flush();
+        Internal::clearPlaylist(*this);
+
+        // Messages of the closed media must not reach the next one
+        gst_bus_set_flushing(bus, TRUE);
+        gst_bus_set_flushing(bus, FALSE);
+        Internal::clearEvents(*this);
 
-            gst_element_set_state(mPipeline, GST_STATE_READY);
-            if (gst_element_get_state(mPipeline, &state, nullptr, 10 * GST_SECOND) == GST_STATE_CHANGE_FAILURE ||
-                state != GST_STATE_READY)
-            {
-                onError("Failed to put pipeline in READY state.");
-                return success;
-            }
+        Internal::reset(*this);
+        mPipeline   = pipeline;
+        mGstBus     = bus;
+        mBusWatch   = watch;
+        return;
+    }
 
-            gst_element_set_state(mPipeline, GST_STATE_PAUSED);
-            if (gst_element_get_state(mPipeline, &state, nullptr, 10 * GST_SECOND) == GST_STATE_CHANGE_FAILURE ||
-                state != GST_STATE_PAUSED)
-            {
-                onError("Failed to put pipeline in PAUSE state.");
-                return success;
-            }
+    stop();
+    Internal::releasePipeline(*this);
+    if (mFrameQueue != nullptr)    delete mFrameQueue;
+    if (mBufferPool != nullptr)    gst_object_unref(mBufferPool);
+    if (mAudioRing != nullptr)     mAudioRing->flush();
+    Internal::clearPlaylist(*this);
 
-            mDuration = discoverer.getDuration();
-            success = true;
-        }
-        else
-        {
-            onError("Pipeline string is empty.");
-        }
-    }
+    Internal::reset(*this);
+}
 
-    return success;
+void Player::setReusePipeline(bool on)
+{
+    mReusePipeline = on;
 }
 
-bool Player::open(const gchar *path, gint width, gint height)
+bool Player::getReusePipeline() const
 {
-    return open(path, width, height, "BGRA");
+    return mReusePipeline;
 }
 
-bool Player::open(const gchar *path, const gchar* fmt)
+bool Player::enqueue(const gchar *path)
 {
-    Discoverer discoverer;
-    return discoverer.open(path) && open(path, discoverer.getWidth(), discoverer.getHeight(), fmt);
+    g_return_val_if_fail(mPipeline != nullptr, false);
+
+    gchar* uri = Internal::processPath(path);
+    if (Internal::isNullOrEmpty(uri))
+    {
+        g_free(uri);
+        onError("Supplied media path is empty.");
+        return false;
+    }
 
+    g_mutex_lock(&mPlaylistLock);
+    g_queue_push_tail(&mPlaylist, uri);
+    g_mutex_unlock(&mPlaylistLock);
+    return true;
 }
 
-bool Player::open(const gchar *path)
+void Player::clearQueue()
 {
-    Discoverer discoverer;
-    return discoverer.open(path) && open(path, discoverer.getWidth(), discoverer.getHeight());
+    g_mutex_lock(&mPlaylistLock);
+    while (gpointer uri = g_queue_pop_head(&mPlaylist)) g_free(uri);
+    g_mutex_unlock(&mPlaylistLock);
 }
 
-void Player::close()
+guint Player::getQueueLength() const
 {
-    stop();
-
-    if (mPipeline != nullptr)      gst_object_unref(mPipeline);
-    if (mGstBus != nullptr)        gst_object_unref(mGstBus);
-    if (mCurrentBuffer != nullptr) gst_buffer_unmap(mCurrentBuffer, &mCurrentMapInfo);
-    if (mCurrentSample != nullptr) gst_sample_unref(mCurrentSample);
+    g_mutex_lock(&mPlaylistLock);
+    guint length = g_queue_get_length(const_cast<GQueue*>(&mPlaylist));
+    g_mutex_unlock(&mPlaylistLock);
+    return length;
+}
 
-    Internal::reset(*this);
+const gchar* Player::getUri() const
+{
+    // Only written by the thread calling open() and update()
+    return Internal::isNullOrEmpty(mTrackUri) ? "" : mTrackUri;
 }
 
 void Player::setState(GstState state)
 {
     g_return_if_fail(mPipeline != nullptr);
+
+    // A blocked streaming thread holds the sink's preroll lock, which pausing and shutting down both need.
+    // It drops its frame for the duration of the change, and for good once the pipeline is at READY or below
+    if (mFrameQueue != nullptr) mFrameQueue->setFlushing(state <= GST_STATE_PAUSED);
     gst_element_set_state(mPipeline, state);
+    if (mFrameQueue != nullptr && state == GST_STATE_PAUSED) mFrameQueue->setFlushing(false);
 }
 
 GstState Player::getState() const
@@ -310,101 +735,14 @@ void Player::pause()
 
 void Player::update()
 {
-    if (mGstBus != nullptr)
-    {
-        while (gst_bus_have_pending(mGstBus) != FALSE)
-        {
-            if (GstMessage* msg = gst_bus_pop(mGstBus))
-            {
-                BIND_TO_SCOPE(msg);
-
-                switch (GST_MESSAGE_TYPE(scoped_msg.pointer))
-                {
-                case GST_MESSAGE_ERROR:
-                {
-                    GError *err = nullptr;
-                    BIND_TO_SCOPE(err);
-                    gst_message_parse_error(msg, &err, nullptr);
-                    onError(scoped_err.pointer->message);
-                    close();
-                }
-                break;
-
-                case GST_MESSAGE_STATE_CHANGED:
-                {
-                    if (GST_MESSAGE_SRC(msg) != GST_OBJECT(mPipeline))
-                        break;
-
-                    GstState old_state = GST_STATE_NULL;
-                    gst_message_parse_state_changed(msg, &old_state, &mState, nullptr);
-
-                    if (old_state != mState)
-                    {
-                        onState(old_state);
-                    }
-                }
-                break;
-
-                case GST_MESSAGE_ASYNC_DONE:
-                {
-                    Internal::processDuration(*this);
-
-                    if (mSeekingLock)
-                    {
-                        mSeekingLock = false;
-                    }
-
-                    if (mPendingSeek >= 0.)
-                    {
-                        setTime(mPendingSeek);
-                    }
-                }
-                break;
-
-                case GST_MESSAGE_DURATION_CHANGED:
-                {
-                    Internal::processDuration(*this);
-                }
-                break;
-
-                case GST_MESSAGE_EOS:
-                {
-                    onStreamEnd();
-
-                    if (getLoop())
-                    {
-                        replay();
-                    }
-                    else
-                    {
-                        pause();
-                    }
-                }
-                break;
-
-                default:
-                    break;
-                }
-            }
-        }
-    }
-
-    if (g_atomic_int_get(&mBufferDirty) != FALSE)
-    {
-        onFrame(
-            mCurrentMapInfo.data,
-            mCurrentMapInfo.size);
-
-        // free current resources on previous frame
-        if (mCurrentBuffer) gst_buffer_unmap(mCurrentBuffer, &mCurrentMapInfo);
-        if (mCurrentSample) gst_sample_unref(mCurrentSample);
-
-        mCurrentBuffer = nullptr;
-        mCurrentSample = nullptr;
+    update(-1);
+}
 
-        // Signal Streaming thread it can produce
-        g_atomic_int_set(&mBufferDirty, FALSE);
-    }
+void Player::update(gint64 vblank)
+{
+    TRACE_SCOPE("update");
+    Internal::processEvents(*this);
+    delete Internal::present(*this, vblank);
 }
 
 gdouble Player::getDuration() const
@@ -415,7 +753,11 @@ gdouble Player::getDuration() const
 void Player::setLoop(bool on)
 {
     g_return_if_fail(mLoop != on);
+
+    // Read by the streaming thread when the current media is about to finish
+    g_mutex_lock(&mPlaylistLock);
     mLoop = on;
+    g_mutex_unlock(&mPlaylistLock);
 }
 
 bool Player::getLoop() const
@@ -427,24 +769,65 @@ void Player::setTime(gdouble time)
 {
     g_return_if_fail(mPipeline != nullptr);
 
+    if (mScrubbing)
+    {
+        mScrubTarget = time;
+    }
+
+    // Only the latest of the seeks requested while one is in flight is executed
     if (mSeekingLock)
     {
         mPendingSeek = time;
         return;
     }
-    else if (gst_element_seek_simple(
+
+    // Scrubbing lands on the nearest key frame instead of decoding up to time
+    GstSeekFlags flags = mScrubbing
+        ? GstSeekFlags(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT | GST_SEEK_FLAG_SNAP_NEAREST)
+        : GstSeekFlags(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE);
+
+    TRACE_SCOPE("seek");
+
+    // Flushing seek waits for the streaming thread, which must not be blocked
+    if (mFrameQueue != nullptr) mFrameQueue->setFlushing(true);
+
+    if (gst_element_seek_simple(
         mPipeline,
         GST_FORMAT_TIME,
-        GstSeekFlags(
-            GST_SEEK_FLAG_FLUSH |
-            GST_SEEK_FLAG_ACCURATE),
+        flags,
         gint64(CLAMP(time, 0, mDuration) * GST_SECOND)))
     {
         mSeekingLock = true;
         mPendingSeek = -1.;
+        mSeekStart   = g_get_monotonic_time();
+    }
+
+    if (mFrameQueue != nullptr) mFrameQueue->setFlushing(false);
+}
+
+void Player::setScrubbing(bool on)
+{
+    if (mScrubbing == on) return;
+    mScrubbing = on;
+
+    if (on)
+    {
+        mScrubTarget = -1.;
+    }
+    else if (mScrubTarget >= 0.)
+    {
+        // One accurate seek to where scrubbing stopped
+        gdouble target = mScrubTarget;
+        mScrubTarget = -1.;
+        if (mPipeline != nullptr) setTime(target);
     }
 }
 
+bool Player::getScrubbing() const
+{
+    return mScrubbing;
+}
+
 gdouble Player::getTime() const
 {
     g_return_val_if_fail(mPipeline != nullptr, 0.);
@@ -536,6 +919,8 @@ void Player::setRate(gdouble rate)
             GST_SEEK_TYPE_SET, 0, GST_SEEK_TYPE_SET, position);
     }
 
+    if (mFrameQueue != nullptr) mFrameQueue->setFlushing(true);
+
     if (gst_element_send_event(mPipeline, seek_event) != FALSE) {
         mRate = rate;
     }
@@ -543,6 +928,8 @@ void Player::setRate(gdouble rate)
         onError("Pipeline did not handle the set rate event. Probably media does not support it.");
         gst_object_unref(seek_event);
     }
+
+    if (mFrameQueue != nullptr) mFrameQueue->setFlushing(false);
 }
 
 gdouble Player::getRate() const
@@ -550,33 +937,435 @@ gdouble Player::getRate() const
     return mRate;
 }
 
-GstMapInfo Player::getMapInfo() const
+void Player::setFrameQueue(FrameQueuePolicy policy, guint depth)
 {
-    return mCurrentMapInfo;
+    g_return_if_fail(policy >= FRAME_QUEUE_LATEST && policy < FRAME_QUEUE_POLICY_COUNT);
+
+    mQueuePolicy = policy;
+    mQueueDepth  = policy == FRAME_QUEUE_LATEST ? 1 : CLAMP(depth, 1u, guint(MAX_FRAME_QUEUE_DEPTH));
 }
 
-GstSample* Player::getSample() const
+FrameQueuePolicy Player::getFrameQueuePolicy() const
 {
-    return mCurrentSample;
+    return mQueuePolicy;
 }
 
-GstBuffer* Player::getBuffer() const
+guint Player::getFrameQueueDepth() const
 {
-    return mCurrentBuffer;
+    return mQueueDepth;
 }
 
-Discoverer::Discoverer(const Discoverer& rhs)
+void Player::setFrameLead(gdouble seconds)
 {
-    Internal::reset(*this);
-    
-    mMediaUri   = g_strdup(rhs.getUri());
-    mWidth      = rhs.getWidth();
-    mHeight     = rhs.getHeight();
-    mFrameRate  = rhs.getFrameRate();
-    mHasAudio   = rhs.getHasAudio();
-    mHasVideo   = rhs.getHasVideo();
-    mSeekable   = rhs.getSeekable();
-    mDuration   = rhs.getDuration();
+    mFrameLead = seconds > 0. ? seconds : 0.;
+}
+
+gdouble Player::getFrameLead() const
+{
+    return mFrameLead;
+}
+
+void Player::setBusThread(bool on)
+{
+    mBusThread = on;
+}
+
+bool Player::getBusThread() const
+{
+    return mBusThread;
+}
+
+void Player::setAudioTap(const gchar* format, gint rate, gint channels, guint latency)
+{
+    g_free(mAudioCaps);
+    mAudioCaps      = nullptr;
+    mAudioBpf       = 0;
+    mAudioRingSize  = 0;
+
+    // Whatever is left over is never read once the system output is back
+    if (mAudioRing != nullptr)
+        mAudioRing->flush();
+
+    if (format == nullptr)
+        return;
+
+    g_return_if_fail(rate > 0 && channels > 0 && latency > 0);
+
+    gchar* caps_str = g_strdup_printf("audio/x-raw,format=%s,rate=%d,channels=%d,layout=interleaved", format, rate, channels);
+    GstCaps* caps = gst_caps_from_string(caps_str);
+
+    GstAudioInfo info;
+    if (caps == nullptr || gst_audio_info_from_caps(&info, caps) == FALSE)
+    {
+        g_free(caps_str);
+        if (caps != nullptr) gst_caps_unref(caps);
+        g_debug("Audio tap format %s is not supported.", format);
+        return;
+    }
+
+    gst_caps_unref(caps);
+
+    const guint64 bytes = guint64(latency) * guint(rate) / 1000 * GST_AUDIO_INFO_BPF(&info);
+    g_return_if_fail(bytes <= G_MAXINT / 2);
+
+    mAudioCaps      = caps_str;
+    mAudioBpf       = guint(GST_AUDIO_INFO_BPF(&info));
+    mAudioRingSize  = 1u << g_bit_storage(MAX(guint(bytes), mAudioBpf) - 1);
+
+    // Audio thread or a playing media may still be inside the old ring, it is swapped and freed with the player
+    if (mAudioRing == nullptr || mAudioRing->bpf != mAudioBpf || mAudioRing->size != mAudioRingSize)
+    {
+        AudioRing* retired = static_cast<AudioRing*>(g_atomic_pointer_get(&mAudioRing));
+        g_atomic_pointer_set(&mAudioRing, new AudioRing(mAudioRingSize, mAudioBpf));
+        if (retired != nullptr) mRetiredAudioRings = g_slist_prepend(mRetiredAudioRings, retired);
+    }
+}
+
+bool Player::getAudioTap() const
+{
+    return mAudioCaps != nullptr;
+}
+
+gsize Player::readAudio(guchar* dst, gsize size)
+{
+    AudioRing* ring = static_cast<AudioRing*>(g_atomic_pointer_get(&mAudioRing));
+    return ring != nullptr ? ring->pull(dst, size) : 0;
+}
+
+gsize Player::getAudioAvailable() const
+{
+    AudioRing* ring = static_cast<AudioRing*>(g_atomic_pointer_get(&mAudioRing));
+    return ring != nullptr ? ring->available() : 0;
+}
+
+void Player::setCrop(gint left, gint top, gint right, gint bottom)
+{
+    g_return_if_fail(left >= 0 && top >= 0 && right >= 0 && bottom >= 0);
+
+    // At least a pixel must be left of the video being played
+    g_return_if_fail(mSourceWidth <= 0 || left + right < mSourceWidth);
+    g_return_if_fail(mSourceHeight <= 0 || top + bottom < mSourceHeight);
+
+    mCrop[0] = left;
+    mCrop[1] = top;
+    mCrop[2] = right;
+    mCrop[3] = bottom;
+
+    if (mPipeline == nullptr)
+        return;
+
+    // Installed by open(...) for every video, passes frames through uncropped at 0, 0, 0, 0
+    GstElement *crop = nullptr;
+    g_object_get(mPipeline, "video-filter", &crop, nullptr);
+
+    if (crop != nullptr)
+    {
+        Internal::applyCrop(*this, crop);
+        gst_object_unref(crop);
+    }
+}
+
+void Player::getCrop(gint& left, gint& top, gint& right, gint& bottom) const
+{
+    left    = mCrop[0];
+    top     = mCrop[1];
+    right   = mCrop[2];
+    bottom  = mCrop[3];
+}
+
+void Player::setPaddedFrames(bool on)
+{
+    mPaddedFrames = on;
+}
+
+bool Player::getPaddedFrames() const
+{
+    return mPaddedFrames;
+}
+
+void Player::setSync(bool on)
+{
+    mSync = on;
+}
+
+bool Player::getSync() const
+{
+    return mSync;
+}
+
+void Player::setFramePool(guchar* const* buffers, guint count, gsize size)
+{
+    g_free(mPoolBuffers);
+    mPoolBuffers    = nullptr;
+    mPoolCount      = 0;
+    mPoolSize       = 0;
+
+    if (buffers == nullptr || count == 0 || size == 0)
+        return;
+
+    mPoolBuffers    = g_new(guchar*, count);
+    mPoolCount      = count;
+    mPoolSize       = size;
+
+    for (guint index = 0; index < count; ++index)
+        mPoolBuffers[index] = buffers[index];
+}
+
+PlayerStats Player::getStats() const
+{
+    const PlayerCounters& counters = *mCounters;
+    PlayerStats stats;
+
+    stats.framesReceived    = counters.get(counters.received);
+    stats.framesDelivered   = counters.delivered;
+    stats.seeks             = counters.seeks;
+    stats.busMessages       = counters.get(counters.messages);
+    stats.bytesCopied       = counters.bytesCopied;
+
+    for (gint reason = 0; reason < FRAME_DROP_REASON_COUNT; ++reason)
+    {
+        stats.framesDropped[reason] = counters.get(counters.dropped[reason]);
+    }
+
+    if (counters.delivered > 0)
+    {
+        stats.averageLatency    = counters.latency / (1000. * counters.delivered);
+        stats.averageFrameTime  = counters.frameTime / (1000. * counters.delivered);
+    }
+
+    if (counters.seeks > 0)
+    {
+        stats.averageSeekLatency = counters.seekLatency / (1000. * counters.seeks);
+    }
+
+    stats.maxLatency        = counters.maxLatency / 1000.;
+    stats.maxFrameTime      = counters.maxFrameTime / 1000.;
+    stats.maxSeekLatency    = counters.maxSeekLatency / 1000.;
+    return stats;
+}
+
+void Player::addCopiedBytes(guint64 bytes) const
+{
+    mCounters->bytesCopied += bytes;
+}
+
+void Player::addDroppedFrame(FrameDropReason reason) const
+{
+    g_return_if_fail(reason >= 0 && reason < FRAME_DROP_REASON_COUNT);
+
+    mCounters->add(mCounters->dropped[reason]);
+}
+
+void Player::setDecoderProperty(const gchar* name, const gchar* value)
+{
+    g_return_if_fail(!Internal::isNullOrEmpty(name));
+
+    if (value != nullptr)
+    {
+        g_hash_table_replace(mDecoderProps, g_strdup(name), g_strdup(value));
+    }
+    else
+    {
+        g_hash_table_remove(mDecoderProps, name);
+    }
+}
+
+void Player::setDecoderThreads(guint threads)
+{
+    mDecoderThreads = threads;
+}
+
+guint Player::getDecoderThreads() const
+{
+    return mDecoderThreads;
+}
+
+void Player::setConvertOptions(const ConvertOptions& options)
+{
+    g_return_if_fail(options.scale >= SCALE_DEFAULT && options.scale < SCALE_METHOD_COUNT);
+    g_return_if_fail(options.dither >= DITHER_DEFAULT && options.dither < DITHER_METHOD_COUNT);
+
+    mConvert = options;
+}
+
+const ConvertOptions& Player::getConvertOptions() const
+{
+    return mConvert;
+}
+
+guint Player::getDroppedFrames(FrameQueuePolicy policy) const
+{
+    g_return_val_if_fail(policy >= FRAME_QUEUE_LATEST && policy < FRAME_QUEUE_POLICY_COUNT, 0);
+    return guint(g_atomic_int_get(&mDroppedFrames[policy]));
+}
+
+GstMapInfo Player::getMapInfo() const
+{
+    return mCurrentFrame != nullptr ? mCurrentFrame->getMapInfo() : GstMapInfo();
+}
+
+GstSample* Player::getSample() const
+{
+    return mCurrentFrame != nullptr ? mCurrentFrame->getSample() : nullptr;
+}
+
+GstBuffer* Player::getBuffer() const
+{
+    return mCurrentFrame != nullptr ? mCurrentFrame->getBuffer() : nullptr;
+}
+
+Frame Player::leaseFrame() const
+{
+    Frame frame;
+    g_return_val_if_fail(mCurrentFrame != nullptr, frame);
+
+    if (Internal::mapSample(frame, gst_sample_ref(mCurrentFrame->getSample())))
+        Internal::copyInfo(frame, *mCurrentFrame);
+
+    return frame;
+}
+
+gint Player::getFramePoolIndex() const
+{
+    g_return_val_if_fail(mCurrentFrame != nullptr, -1);
+
+    // Tagged by the pool that wrapped the buffer, so it holds even if setFramePool(...) was called since
+    const guint tag = GPOINTER_TO_UINT(gst_mini_object_get_qdata(
+        GST_MINI_OBJECT(mCurrentFrame->getBuffer()), Internal::framePoolQuark()));
+    return gint(tag) - 1;
+}
+
+bool Player::getFrameLayout(FrameLayout& layout) const
+{
+    g_return_val_if_fail(mCurrentFrame != nullptr, false);
+
+    // Described once by the streaming thread
+    layout = mCurrentFrame->getInfo().layout;
+    return layout.planes > 0;
+}
+
+gsize Player::copyFrame(guchar* dst, gsize size) const
+{
+    g_return_val_if_fail(mCurrentFrame != nullptr && dst != nullptr, 0);
+
+    GstVideoInfo info;
+    GstCaps* caps = gst_sample_get_caps(getSample());
+    if (caps == nullptr || gst_video_info_from_caps(&info, caps) == FALSE || size < info.size)
+        return 0;
+
+    GstBuffer* buffer = getBuffer();
+
+    // Without video meta the buffer already is in the default layout
+    if (gst_buffer_get_video_meta(buffer) == nullptr)
+        return gst_buffer_extract(buffer, 0, dst, info.size);
+
+    GstBuffer* packed = gst_buffer_new_wrapped_full(GstMemoryFlags(0), dst, info.size, 0, info.size, nullptr, nullptr);
+    GstVideoFrame src_frame, dst_frame;
+    gsize copied = 0;
+
+    if (gst_video_frame_map(&src_frame, &info, buffer, GST_MAP_READ) != FALSE)
+    {
+        if (gst_video_frame_map(&dst_frame, &info, packed, GST_MAP_WRITE) != FALSE)
+        {
+            if (gst_video_frame_copy(&dst_frame, &src_frame) != FALSE) copied = info.size;
+            gst_video_frame_unmap(&dst_frame);
+        }
+
+        gst_video_frame_unmap(&src_frame);
+    }
+
+    gst_buffer_unref(packed);
+    return copied;
+}
+
+Frame::Frame()
+{
+    Internal::reset(*this);
+}
+
+Frame::~Frame()
+{
+    release();
+}
+
+Frame::Frame(Frame&& rhs)
+    : mSample(rhs.mSample)
+    , mBuffer(rhs.mBuffer)
+    , mMapInfo(rhs.mMapInfo)
+    , mInfo(rhs.mInfo)
+{
+    Internal::reset(rhs);
+}
+
+Frame& Frame::operator=(Frame&& rhs)
+{
+    if (this != &rhs)
+    {
+        release();
+
+        mSample  = rhs.mSample;
+        mBuffer  = rhs.mBuffer;
+        mMapInfo = rhs.mMapInfo;
+        mInfo    = rhs.mInfo;
+
+        Internal::reset(rhs);
+    }
+
+    return *this;
+}
+
+void Frame::release()
+{
+    if (mBuffer != nullptr) gst_buffer_unmap(mBuffer, &mMapInfo);
+    if (mSample != nullptr) gst_sample_unref(mSample);
+
+    Internal::reset(*this);
+}
+
+bool Frame::isValid() const
+{
+    return mSample != nullptr;
+}
+
+guchar* Frame::getData() const
+{
+    return mMapInfo.data;
+}
+
+gsize Frame::getSize() const
+{
+    return mMapInfo.size;
+}
+
+const GstMapInfo& Frame::getMapInfo() const
+{
+    return mMapInfo;
+}
+
+GstSample* Frame::getSample() const
+{
+    return mSample;
+}
+
+GstBuffer* Frame::getBuffer() const
+{
+    return mBuffer;
+}
+
+bool Frame::getLayout(FrameLayout& layout) const
+{
+    return Internal::layout(*this, layout);
+}
+
+const FrameInfo& Frame::getInfo() const
+{
+    return mInfo;
+}
+
+Discoverer::Discoverer(const Discoverer& rhs)
+{
+    Internal::reset(*this);
+    Internal::copy(*this, rhs);
 }
 
 Discoverer::Discoverer()
@@ -591,6 +1380,7 @@ Discoverer::~Discoverer()
 
 bool Discoverer::open(const gchar* path)
 {
+    TRACE_SCOPE("discover");
     bool success = false;
 
     if (!Internal::gstreamerInitialized())
@@ -608,53 +1398,18 @@ bool Discoverer::open(const gchar* path)
         mMediaUri = Internal::processPath(path);
         if (Internal::isNullOrEmpty(mMediaUri)) return success;
 
+        if (DiscoveryCache::get().lookup(mMediaUri, *this)) return true;
+
         if (GstDiscoverer *discoverer = gst_discoverer_new(DISCOVER_TIMEOUT, nullptr))
         {
             BIND_TO_SCOPE(discoverer);
             if (GstDiscovererInfo *info = gst_discoverer_discover_uri(discoverer, mMediaUri, nullptr))
             {
                 BIND_TO_SCOPE(info);
-                if (gst_discoverer_info_get_result(scoped_info.pointer) == GST_DISCOVERER_OK)
+                if (Internal::fill(*this, info))
                 {
-                    if (GList *video_streams = gst_discoverer_info_get_video_streams(info))
-                    {
-                        mHasVideo = true;
-                        BIND_TO_SCOPE(video_streams);
-
-                        for (GList *curr = scoped_video_streams.pointer; curr; curr = curr->next)
-                        {
-                            GstDiscovererStreamInfo *curr_sinfo = (GstDiscovererStreamInfo *)curr->data;
-
-                            if (GST_IS_DISCOVERER_VIDEO_INFO(curr_sinfo))
-                            {
-                                mWidth      = gst_discoverer_video_info_get_width(GST_DISCOVERER_VIDEO_INFO(curr_sinfo));
-                                mHeight     = gst_discoverer_video_info_get_height(GST_DISCOVERER_VIDEO_INFO(curr_sinfo));
-                                mFrameRate  = gst_discoverer_video_info_get_framerate_num(GST_DISCOVERER_VIDEO_INFO(curr_sinfo))
-                                    / float(gst_discoverer_video_info_get_framerate_denom(GST_DISCOVERER_VIDEO_INFO(curr_sinfo)));
-                            }
-                        }
-                    }
-
-                    if (GList *audio_streams = gst_discoverer_info_get_audio_streams(info))
-                    {
-                        mHasAudio = true;
-                        BIND_TO_SCOPE(audio_streams);
-
-                        for (GList *curr = scoped_audio_streams.pointer; curr; curr = curr->next)
-                        {
-                            GstDiscovererStreamInfo *curr_sinfo = (GstDiscovererStreamInfo *)curr->data;
-
-                            if (GST_IS_DISCOVERER_AUDIO_INFO(curr_sinfo))
-                            {
-                                mSampleRate = gst_discoverer_audio_info_get_sample_rate(GST_DISCOVERER_AUDIO_INFO(curr_sinfo));
-                                mBitRate    = gst_discoverer_audio_info_get_bitrate(GST_DISCOVERER_AUDIO_INFO(curr_sinfo));
-                            }
-                        }
-                    }
-
-                    mSeekable = gst_discoverer_info_get_seekable(info) != FALSE;
-                    mDuration = gst_discoverer_info_get_duration(info) / gdouble(GST_SECOND);
                     success = true;
+                    DiscoveryCache::get().store(*this);
                 }
             }
         }
@@ -718,153 +1473,3002 @@ guint Discoverer::getBitRate() const
     return mBitRate;
 }
 
-//////////////////////////////////////////////////////////////////////////
-// Internal implementation
-//////////////////////////////////////////////////////////////////////////
+DiscovererBatch::DiscovererBatch(guint workers)
+    : mPaths(g_async_queue_new_full(g_free))
+    , mResults(g_async_queue_new())
+    , mWorkerCount(workers > 0 ? workers : MAX(g_get_num_processors(), 1u))
+{}
 
-bool Internal::isNullOrEmpty(const gchar* const str)
+DiscovererBatch::~DiscovererBatch()
 {
-    return str == nullptr || !*str;
+    cancel();
+
+    if (mWorkers != nullptr)
+    {
+        // Workers stop once they pop the batch itself off the queue
+        for (guint index = 0; index < mWorkerCount; ++index)
+            g_async_queue_push(mPaths, this);
+
+        for (guint index = 0; index < mWorkerCount; ++index)
+            g_thread_join(mWorkers[index]);
+
+        g_free(mWorkers);
+        mWorkers = nullptr;
+    }
+
+    while (gpointer task = g_async_queue_try_pop(mResults))
+        delete static_cast<DiscoveryTask*>(task);
+
+    g_async_queue_unref(mResults);
+    g_async_queue_unref(mPaths);
+    DiscoveryCache::get().flush();
 }
 
-gchar* Internal::processPath(const gchar* path)
+bool DiscovererBatch::add(const gchar* path)
 {
-    if (isNullOrEmpty(path))
+    if (Internal::isNullOrEmpty(path)) return false;
+
+    if (!Internal::gstreamerInitialized())
     {
-        g_debug("Cannot process an empty path.");
-        return nullptr;
+        g_debug("You cannot discover a media with ngw. %s",
+                "GStreamer could not be initialized.");
+        return false;
     }
 
-    gchar* processed_path = nullptr;
-
-    // This will be NULL if path is already a valid URI
-    gchar* uri = g_filename_to_uri(path, nullptr, nullptr);
+    if (mWorkers == nullptr)
+    {
+        mWorkers = g_new0(GThread*, mWorkerCount);
 
-    if (!isNullOrEmpty(uri)) {
-        processed_path = uri;
-    } else {
-        processed_path = g_strdup(path);
+        for (guint index = 0; index < mWorkerCount; ++index)
+            mWorkers[index] = g_thread_new("ngw-discoverer", &Internal::discoverMedia, this);
     }
 
-    return processed_path;
+    g_atomic_int_inc(&mPending);
+    g_async_queue_push(mPaths, g_strdup(path));
+    return true;
 }
 
-void Internal::reset(ngw::Player& player)
+void DiscovererBatch::update()
 {
-    player.mState         = GST_STATE_NULL;
-    player.mPipeline      = nullptr;
-    player.mGstBus        = nullptr;
-    player.mCurrentBuffer = nullptr;
-    player.mCurrentSample = nullptr;
-    player.mWidth         = 0;
-    player.mHeight        = 0;
-    player.mDuration      = 0;
-    player.mTime          = 0.;
-    player.mVolume        = 1.;
-    player.mRate          = 1.;
-    player.mPendingSeek   = 0.;
-    player.mSeekingLock   = false;
-    g_atomic_int_set(&player.mBufferDirty, FALSE);
+    while (gpointer task = g_async_queue_try_pop(mResults))
+        Internal::processDiscovery(*this, task);
 }
 
-void Internal::reset(Discoverer& discoverer)
+void DiscovererBatch::wait()
 {
-    if (!isNullOrEmpty(discoverer.mMediaUri))
+    while (!isDone())
+        Internal::processDiscovery(*this, g_async_queue_pop(mResults));
+}
+
+void DiscovererBatch::cancel()
+{
+    while (gpointer path = g_async_queue_try_pop(mPaths))
+    {
+        g_free(path);
+        if (g_atomic_int_dec_and_test(&mPending))
+            DiscoveryCache::get().flush();
+    }
+}
+
+guint DiscovererBatch::getPending() const
+{
+    return guint(g_atomic_int_get(&mPending));
+}
+
+bool DiscovererBatch::isDone() const
+{
+    return getPending() == 0;
+}
+
+PlayerGroup::PlayerGroup()
+    : mClock(gst_system_clock_obtain())
+    , mPlayers(g_ptr_array_new())
+{}
+
+PlayerGroup::~PlayerGroup()
+{
+    while (mPlayers->len > 0)
+        remove(*static_cast<Player*>(g_ptr_array_index(mPlayers, mPlayers->len - 1)));
+
+    g_ptr_array_unref(mPlayers);
+    gst_object_unref(mClock);
+}
+
+bool PlayerGroup::add(Player& player)
+{
+    for (guint index = 0; index < mPlayers->len; ++index)
+    {
+        if (g_ptr_array_index(mPlayers, index) == &player) return false;
+    }
+
+    g_ptr_array_add(mPlayers, &player);
+    Internal::slave(*this, player);
+    return true;
+}
+
+void PlayerGroup::remove(Player& player)
+{
+    if (g_ptr_array_remove(mPlayers, &player) != FALSE)
+    {
+        Internal::unslave(player);
+    }
+}
+
+guint PlayerGroup::getSize() const
+{
+    return mPlayers->len;
+}
+
+void PlayerGroup::play()
+{
+    // Same base time on every member, running time of the group resumes GROUP_START_DELAY from now
+    mBaseTime = gst_clock_get_time(mClock) + GROUP_START_DELAY - mRunningTime;
+
+    for (guint index = 0; index < mPlayers->len; ++index)
+    {
+        Player* player = static_cast<Player*>(g_ptr_array_index(mPlayers, index));
+        Internal::slave(*this, *player);
+        Internal::start(*player, mBaseTime);
+    }
+
+    mPlaying = true;
+}
+
+void PlayerGroup::pause()
+{
+    if (mPlaying)
+    {
+        GstClockTime now = gst_clock_get_time(mClock);
+        mRunningTime = now > mBaseTime ? now - mBaseTime : 0;
+        mPlaying = false;
+    }
+
+    for (guint index = 0; index < mPlayers->len; ++index)
+    {
+        Player* player = static_cast<Player*>(g_ptr_array_index(mPlayers, index));
+        if (Internal::isOpen(*player)) player->pause();
+    }
+}
+
+void PlayerGroup::setTime(gdouble time)
+{
+    const bool playing = mPlaying;
+    pause();
+
+    // Issue every seek first so members pre-roll in parallel
+    for (guint index = 0; index < mPlayers->len; ++index)
+    {
+        Player* player = static_cast<Player*>(g_ptr_array_index(mPlayers, index));
+        Internal::slave(*this, *player);
+        Internal::seek(*player, time);
+    }
+
+    for (guint index = 0; index < mPlayers->len; ++index)
+    {
+        Internal::preroll(*static_cast<Player*>(g_ptr_array_index(mPlayers, index)));
+    }
+
+    // Flushing seeks restart running time of every member from 0
+    mRunningTime = 0;
+    mPosition = MAX(time, 0.);
+    if (playing) play();
+}
+
+gdouble PlayerGroup::getTime() const
+{
+    // Derived from the shared clock rather than a member, which may drift itself
+    GstClockTime running_time = mRunningTime;
+    if (mPlaying)
+    {
+        const GstClockTime now = gst_clock_get_time(mClock);
+        running_time = now > mBaseTime ? now - mBaseTime : 0;
+    }
+
+    return mPosition + running_time / gdouble(GST_SECOND);
+}
+
+gdouble PlayerGroup::getDrift(const Player& player) const
+{
+    return player.getTime() - getTime();
+}
+
+GstClock* PlayerGroup::getClock() const
+{
+    return mClock;
+}
+
+PlayerManager::PlayerManager(guint workers)
+    : mPlayers(g_ptr_array_new())
+    , mUpdating(g_ptr_array_new())
+{
+    g_mutex_init(&mLock);
+    g_cond_init(&mCond);
+
+    if (workers > 0)
+    {
+        mWorkers = g_thread_pool_new(&Internal::processFrame, this, gint(workers), FALSE, nullptr);
+    }
+}
+
+PlayerManager::~PlayerManager()
+{
+    // update(...) never returns with frames in flight, nothing to wait for
+    if (mWorkers != nullptr)
+        g_thread_pool_free(mWorkers, FALSE, TRUE);
+
+    g_ptr_array_unref(mPlayers);
+    g_ptr_array_unref(mUpdating);
+    g_mutex_clear(&mLock);
+    g_cond_clear(&mCond);
+}
+
+bool PlayerManager::add(Player& player)
+{
+    if (Internal::isManaged(*this, &player)) return false;
+
+    g_ptr_array_add(mPlayers, &player);
+    return true;
+}
+
+void PlayerManager::remove(Player& player)
+{
+    g_ptr_array_remove(mPlayers, &player);
+
+    // Called back from update(...), the player may be gone before its turn comes
+    for (guint index = 0; index < mUpdating->len; ++index)
+    {
+        if (g_ptr_array_index(mUpdating, index) == &player) g_ptr_array_index(mUpdating, index) = nullptr;
+    }
+}
+
+guint PlayerManager::getSize() const
+{
+    return mPlayers->len;
+}
+
+Player* PlayerManager::getPlayer(guint index) const
+{
+    return index < mPlayers->len ? static_cast<Player*>(g_ptr_array_index(mPlayers, index)) : nullptr;
+}
+
+guint PlayerManager::update(PlayerState* states, guint count)
+{
+    return update(states, count, -1);
+}
+
+guint PlayerManager::update(PlayerState* states, guint count, gint64 vblank)
+{
+    // Callbacks may add(...) or remove(...) players, walk the ones managed when the update started
+    const guint size = mPlayers->len;
+    g_ptr_array_set_size(mUpdating, gint(size));
+    for (guint index = 0; index < size; ++index)
+        g_ptr_array_index(mUpdating, index) = g_ptr_array_index(mPlayers, index);
+
+    const guint filled = states != nullptr ? MIN(count, size) : 0;
+
+    for (guint index = 0; index < size; ++index)
+    {
+        Player* player = static_cast<Player*>(g_ptr_array_index(mUpdating, index));
+
+        // Removed by a callback of an earlier player
+        if (player == nullptr)
+        {
+            if (index < filled) states[index] = PlayerState();
+            continue;
+        }
+
+        TRACE_SCOPE("update");
+        Internal::processEvents(*player);
+        Frame* frame = Internal::present(*player, vblank);
+
+        if (index < filled)
+            Internal::snapshot(*player, states[index], frame);
+
+        if (frame == nullptr)
+            continue;
+
+        if (mWorkers == nullptr)
+        {
+            onProcess(*player, *frame);
+            delete frame;
+            continue;
+        }
+
+        ProcessTask* task = new ProcessTask();
+        task->player = player;
+        task->frame  = frame;
+
+        g_atomic_int_inc(&mPending);
+        g_thread_pool_push(mWorkers, task, nullptr);
+    }
+
+    // Frames of this update are processed before it returns
+    g_mutex_lock(&mLock);
+    while (g_atomic_int_get(&mPending) > 0)
+    {
+        g_cond_wait(&mCond, &mLock);
+    }
+    g_mutex_unlock(&mLock);
+
+    // Keeps its allocation for the next update
+    g_ptr_array_set_size(mUpdating, 0);
+    return filled;
+}
+
+Thumbnailer::Thumbnailer(guint pipelines)
+    : mRequests(g_async_queue_new())
+    , mResults(g_async_queue_new())
+    , mWorkerCount(pipelines > 0 ? pipelines : MAX(g_get_num_processors(), 1u))
+{}
+
+Thumbnailer::~Thumbnailer()
+{
+    close();
+
+    g_async_queue_unref(mResults);
+    g_async_queue_unref(mRequests);
+}
+
+bool Thumbnailer::open(const gchar *path, gint width, gint height, const gchar* fmt)
+{
+    if (!Internal::gstreamerInitialized())
+    {
+        onError("You cannot open a media with ngw.");
+        return false;
+    }
+
+    // First close any current media.
+    close();
+
+    if (!mDiscoverer.open(path))
+    {
+        onError("Unable to discover the media.");
+        return false;
+    }
+
+    if (!mDiscoverer.getHasVideo() || mDiscoverer.getWidth() <= 0 || mDiscoverer.getHeight() <= 0)
+    {
+        onError("Media provided does not contain video.");
+        return false;
+    }
+
+    // Keep aspect ratio of the video for a missing dimension
+    mWidth  = width;
+    mHeight = height;
+
+    if (mWidth <= 0 && mHeight <= 0)
+    {
+        mWidth  = mDiscoverer.getWidth();
+        mHeight = mDiscoverer.getHeight();
+    }
+    else if (mWidth <= 0)
+    {
+        mWidth  = MAX(1, gint(mHeight * gint64(mDiscoverer.getWidth()) / mDiscoverer.getHeight()));
+    }
+    else if (mHeight <= 0)
+    {
+        mHeight = MAX(1, gint(mWidth * gint64(mDiscoverer.getHeight()) / mDiscoverer.getWidth()));
+    }
+
+    mCaps = Internal::videoCaps(mWidth, mHeight, fmt);
+    return true;
+}
+
+bool Thumbnailer::open(const gchar *path, gint width, gint height)
+{
+    return open(path, width, height, "BGRA");
+}
+
+void Thumbnailer::close()
+{
+    cancel();
+
+    if (mWorkers != nullptr)
+    {
+        // Pipeline threads stop once they pop the thumbnailer itself off the queue
+        for (guint index = 0; index < mWorkerCount; ++index)
+            g_async_queue_push(mRequests, this);
+
+        for (guint index = 0; index < mWorkerCount; ++index)
+            g_thread_join(mWorkers[index]);
+
+        g_free(mWorkers);
+        mWorkers = nullptr;
+    }
+
+    while (gpointer task = g_async_queue_try_pop(mResults))
+        delete static_cast<ThumbnailTask*>(task);
+
+    g_atomic_int_set(&mPending, 0);
+    Internal::reset(mDiscoverer);
+
+    g_free(mCaps);
+    mCaps   = nullptr;
+    mWidth  = 0;
+    mHeight = 0;
+}
+
+bool Thumbnailer::extract(gdouble time)
+{
+    g_return_val_if_fail(mCaps != nullptr, false);
+
+    if (mWorkers == nullptr)
+    {
+        mWorkers = g_new0(GThread*, mWorkerCount);
+
+        for (guint index = 0; index < mWorkerCount; ++index)
+            mWorkers[index] = g_thread_new("ngw-thumbnailer", &Internal::extractThumbnails, this);
+    }
+
+    ThumbnailTask* task = new ThumbnailTask();
+    // Accurate seek to the very end hits EOS while pre-rolling, the last frame starts a frame duration before it
+    const gdouble frame_duration = mDiscoverer.getFrameRate() > 0.f ? 1. / mDiscoverer.getFrameRate() : 1. / 25.;
+    task->time = CLAMP(time, 0., MAX(mDiscoverer.getDuration() - frame_duration, 0.));
+
+    g_atomic_int_inc(&mPending);
+    g_async_queue_push(mRequests, task);
+    return true;
+}
+
+bool Thumbnailer::extractStrip(guint count)
+{
+    g_return_val_if_fail(mCaps != nullptr, false);
+
+    // Middle of each of the "count" equal slices, avoids first and last (often black) frames
+    const gdouble step = mDiscoverer.getDuration() / MAX(count, 1u);
+    for (guint index = 0; index < count; ++index)
+    {
+        extract((index + .5) * step);
+    }
+
+    return count > 0;
+}
+
+void Thumbnailer::update()
+{
+    while (gpointer task = g_async_queue_try_pop(mResults))
+        Internal::processThumbnail(*this, task);
+}
+
+void Thumbnailer::wait()
+{
+    while (!isDone())
+        Internal::processThumbnail(*this, g_async_queue_pop(mResults));
+}
+
+void Thumbnailer::cancel()
+{
+    gpointer task = nullptr;
+    while ((task = g_async_queue_try_pop(mRequests)) != nullptr)
+    {
+        delete static_cast<ThumbnailTask*>(task);
+        g_atomic_int_add(&mPending, -1);
+    }
+}
+
+guint Thumbnailer::getPending() const
+{
+    return guint(g_atomic_int_get(&mPending));
+}
+
+bool Thumbnailer::isDone() const
+{
+    return getPending() == 0;
+}
+
+gint Thumbnailer::getWidth() const
+{
+    return mWidth;
+}
+
+gint Thumbnailer::getHeight() const
+{
+    return mHeight;
+}
+
+const Discoverer& Thumbnailer::getDiscoverer() const
+{
+    return mDiscoverer;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Internal implementation
+//////////////////////////////////////////////////////////////////////////
+
+bool Internal::isNullOrEmpty(const gchar* const str)
+{
+    return str == nullptr || !*str;
+}
+
+gchar* Internal::processPath(const gchar* path)
+{
+    if (isNullOrEmpty(path))
+    {
+        g_debug("Cannot process an empty path.");
+        return nullptr;
+    }
+
+    gchar* processed_path = nullptr;
+
+    // This will be NULL if path is already a valid URI
+    gchar* uri = g_filename_to_uri(path, nullptr, nullptr);
+
+    if (!isNullOrEmpty(uri)) {
+        processed_path = uri;
+    } else {
+        processed_path = g_strdup(path);
+    }
+
+    return processed_path;
+}
+
+void Internal::reset(ngw::Player& player)
+{
+    player.mState         = GST_STATE_NULL;
+    player.mPipeline      = nullptr;
+    player.mGstBus        = nullptr;
+    player.mBusWatch      = nullptr;
+    player.mBusEvents     = nullptr;
+    player.mCurrentFrame  = nullptr;
+    player.mWidth         = 0;
+    player.mHeight        = 0;
+    player.mSourceWidth   = 0;
+    player.mSourceHeight  = 0;
+    player.mDuration      = 0;
+    player.mTime          = 0.;
+    player.mVolume        = 1.;
+    player.mRate          = 1.;
+    player.mFrameCount    = 0;
+    player.mPendingSeek   = -1.;
+    player.mScrubTarget   = -1.;
+    player.mSeekStart     = 0;
+    player.mSeekingLock   = false;
+    player.mFrameQueue    = nullptr;
+    player.mBufferPool    = nullptr;
+    player.mOpenTask      = nullptr;
+    player.mOpening       = false;
+    player.mTrackUri      = nullptr;
+    player.mNextTrackUri  = nullptr;
+
+    for (gint policy = 0; policy < FRAME_QUEUE_POLICY_COUNT; ++policy)
+    {
+        g_atomic_int_set(&player.mDroppedFrames[policy], 0);
+    }
+}
+
+void Internal::reset(Discoverer& discoverer)
+{
+    if (!isNullOrEmpty(discoverer.mMediaUri))
+    {
+        g_free(discoverer.mMediaUri);
+        discoverer.mMediaUri = nullptr;
+    }
+
+    discoverer.mWidth      = 0;
+    discoverer.mHeight     = 0;
+    discoverer.mFrameRate  = 0;
+    discoverer.mSampleRate = 0;
+    discoverer.mBitRate    = 0;
+    discoverer.mHasAudio   = false;
+    discoverer.mHasVideo   = false;
+    discoverer.mSeekable   = false;
+    discoverer.mDuration   = 0;
+}
+
+void Internal::copy(Discoverer& dst, const Discoverer& src)
+{
+    if (&dst == &src) return;
+
+    g_free(dst.mMediaUri);
+    dst.mMediaUri   = g_strdup(src.getUri());
+    dst.mWidth      = src.getWidth();
+    dst.mHeight     = src.getHeight();
+    dst.mFrameRate  = src.getFrameRate();
+    dst.mSampleRate = src.getSampleRate();
+    dst.mBitRate    = src.getBitRate();
+    dst.mHasAudio   = src.getHasAudio();
+    dst.mHasVideo   = src.getHasVideo();
+    dst.mSeekable   = src.getSeekable();
+    dst.mDuration   = src.getDuration();
+}
+
+bool Internal::fill(Discoverer& discoverer, GstDiscovererInfo* info)
+{
+    if (info == nullptr || gst_discoverer_info_get_result(info) != GST_DISCOVERER_OK)
+    {
+        return false;
+    }
+
+    if (GList *video_streams = gst_discoverer_info_get_video_streams(info))
+    {
+        discoverer.mHasVideo = true;
+        BIND_TO_SCOPE(video_streams);
+
+        for (GList *curr = scoped_video_streams.pointer; curr; curr = curr->next)
+        {
+            GstDiscovererStreamInfo *curr_sinfo = (GstDiscovererStreamInfo *)curr->data;
+
+            if (GST_IS_DISCOVERER_VIDEO_INFO(curr_sinfo))
+            {
+                discoverer.mWidth      = gst_discoverer_video_info_get_width(GST_DISCOVERER_VIDEO_INFO(curr_sinfo));
+                discoverer.mHeight     = gst_discoverer_video_info_get_height(GST_DISCOVERER_VIDEO_INFO(curr_sinfo));
+                discoverer.mFrameRate  = gst_discoverer_video_info_get_framerate_num(GST_DISCOVERER_VIDEO_INFO(curr_sinfo))
+                    / float(gst_discoverer_video_info_get_framerate_denom(GST_DISCOVERER_VIDEO_INFO(curr_sinfo)));
+            }
+        }
+    }
+
+    if (GList *audio_streams = gst_discoverer_info_get_audio_streams(info))
+    {
+        discoverer.mHasAudio = true;
+        BIND_TO_SCOPE(audio_streams);
+
+        for (GList *curr = scoped_audio_streams.pointer; curr; curr = curr->next)
+        {
+            GstDiscovererStreamInfo *curr_sinfo = (GstDiscovererStreamInfo *)curr->data;
+
+            if (GST_IS_DISCOVERER_AUDIO_INFO(curr_sinfo))
+            {
+                discoverer.mSampleRate = gst_discoverer_audio_info_get_sample_rate(GST_DISCOVERER_AUDIO_INFO(curr_sinfo));
+                discoverer.mBitRate    = gst_discoverer_audio_info_get_bitrate(GST_DISCOVERER_AUDIO_INFO(curr_sinfo));
+            }
+        }
+    }
+
+    discoverer.mSeekable = gst_discoverer_info_get_seekable(info) != FALSE;
+    discoverer.mDuration = gst_discoverer_info_get_duration(info) / gdouble(GST_SECOND);
+    return true;
+}
+
+gchar* Internal::videoCaps(gint width, gint height, const gchar* fmt)
+{
+    return g_strdup_printf("video/x-raw,width=%d,height=%d,format=%s",
+        width, height, isNullOrEmpty(fmt) ? "BGRA" : fmt);
+}
+
+bool Internal::buildPipeline(Player& player, const Discoverer& discoverer, gint width, gint height, const gchar* fmt)
+{
+    gchar* pipeline_cmd = nullptr;
+    BIND_TO_SCOPE(pipeline_cmd);
+
+    // A reused play-bin always gets an appsink, next media might have video
+    const bool has_video_sink = discoverer.getHasVideo() || player.mReusePipeline;
+
+    // Audio sink waits on the pipeline clock like a system sink would, then hands samples to readAudio(...)
+    gchar* audio_sink = player.mAudioCaps != nullptr
+        ? g_strdup_printf(" audio-sink=\"appsink name=" AUDIO_SINK_NAME " sync=yes caps=%s\"", player.mAudioCaps)
+        : g_strdup("");
+    BIND_TO_SCOPE(audio_sink);
+
+    if (has_video_sink)
+    {
+        gchar* caps = videoCaps(width, height, fmt);
+        BIND_TO_SCOPE(caps);
+
+        // Create the pipeline expression
+        pipeline_cmd = g_strdup_printf(
+            "playbin uri=\"%s\" video-sink=\""
+            "appsink drop=yes async=no qos=yes sync=yes max-lateness=%lld "
+            "caps=%s\"%s",
+            discoverer.getUri(),
+            static_cast<long long>(GST_SECOND),
+            scoped_caps.pointer,
+            scoped_audio_sink.pointer);
+    }
+    else
+    {
+        // Create the pipeline expression
+        pipeline_cmd = g_strdup_printf(
+            "playbin uri=\"%s\"%s",
+            discoverer.getUri(),
+            scoped_audio_sink.pointer);
+    }
+
+    if (isNullOrEmpty(scoped_pipeline_cmd.pointer))
+    {
+        player.onError("Pipeline string is empty.");
+        return false;
+    }
+
+    player.mPipeline = gst_parse_launch(scoped_pipeline_cmd.pointer, nullptr);
+    if (player.mPipeline == nullptr)
+    {
+        // Nothing to stop yet, close() would trip over the missing pipeline
+        reset(player);
+        player.onError("Unable to launch the pipeline.");
+        return false;
+    }
+
+    player.mGstBus = gst_pipeline_get_bus(GST_PIPELINE(player.mPipeline));
+    if (player.mGstBus == nullptr)
+    {
+        releasePipeline(player);
+        reset(player);
+        player.onError("Unable to obtain pipeline's bus.");
+        return false;
+    }
+
+    // Hands the next media to play-bin ahead of time, for gap-less playback
+    g_signal_connect(player.mPipeline, "about-to-finish", G_CALLBACK(&Internal::onAboutToFinish), &player);
+
+    // Reaches decoders nested in decodebin too, before they start decoding
+    g_signal_connect(player.mPipeline, "element-setup", G_CALLBACK(&Internal::onElementSetup), &player);
+
+    if (has_video_sink)
+    {
+        // Play-sink links the video filter ahead of its converter and scaler, so only the cropped pixels go through them.
+        // Installed even without a crop, so setCrop(...) works live
+        GstElement *crop = gst_element_factory_make("videocrop", nullptr);
+
+        if (crop != nullptr)
+        {
+            applyCrop(player, crop);
+            g_object_set(player.mPipeline, "video-filter", crop, nullptr);
+        }
+        else
+        {
+            g_debug("videocrop is not available, video is not cropped.");
+        }
+    }
+
+    if (has_video_sink)
+    {
+        GstAppSink *app_sink = nullptr;
+        BIND_TO_SCOPE(app_sink);
+
+        g_object_get(player.mPipeline, "video-sink", &app_sink, nullptr);
+        if (app_sink == nullptr)
+        {
+            releasePipeline(player);
+            reset(player);
+            player.onError("Unable to obtain pipeline's video sink.");
+            return false;
+        }
+
+        // Configure VideoSink's appsink:
+        typedef GstFlowReturn(*APP_SINK_CB) (GstAppSink*, gpointer);
+        GstAppSinkCallbacks callbacks;
+
+        callbacks.eos           = nullptr;
+        callbacks.new_preroll   = APP_SINK_CB(&Internal::onPreroll);
+        callbacks.new_sample    = APP_SINK_CB(&Internal::onSampled);
+
+        gst_app_sink_set_callbacks(scoped_app_sink.pointer, &callbacks, &player, nullptr);
+
+        // Lets decoders hand off padded (planar) frames as-is, instead of copying them tightly packed
+        if (GstPad *pad = gst_element_get_static_pad(GST_ELEMENT(scoped_app_sink.pointer), "sink"))
+        {
+            gst_pad_add_probe(pad, GstPadProbeType(GST_PAD_PROBE_TYPE_QUERY_DOWNSTREAM | GST_PAD_PROBE_TYPE_PUSH), &Internal::onSinkQuery, &player, nullptr);
+            gst_object_unref(pad);
+        }
+    }
+
+    if (player.mAudioCaps != nullptr)
+    {
+        GstAppSink *app_sink = nullptr;
+        g_object_get(player.mPipeline, "audio-sink", &app_sink, nullptr);
+
+        if (app_sink == nullptr)
+        {
+            releasePipeline(player);
+            reset(player);
+            player.onError("Unable to obtain pipeline's audio sink.");
+            return false;
+        }
+
+        BIND_TO_SCOPE(app_sink);
+
+        typedef GstFlowReturn(*APP_SINK_CB) (GstAppSink*, gpointer);
+        GstAppSinkCallbacks callbacks;
+
+        callbacks.eos           = nullptr;
+        callbacks.new_preroll   = nullptr;
+        callbacks.new_sample    = APP_SINK_CB(&Internal::onAudioSampled);
+
+        gst_app_sink_set_callbacks(scoped_app_sink.pointer, &callbacks, &player, nullptr);
+
+        // Samples queued before a seek must not be heard after it
+        if (GstPad *pad = gst_element_get_static_pad(GST_ELEMENT(scoped_app_sink.pointer), "sink"))
+        {
+            gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_EVENT_FLUSH, &Internal::onAudioFlush, &player, nullptr);
+            gst_object_unref(pad);
+        }
+    }
+
+    return true;
+}
+
+bool Internal::reusePipeline(Player& player, const Discoverer& discoverer, gint width, gint height, const gchar* fmt)
+{
+    GstElement *audio_sink = nullptr;
+    g_object_get(player.mPipeline, "audio-sink", &audio_sink, nullptr);
+
+    const bool tapped = audio_sink != nullptr && GST_IS_APP_SINK(audio_sink);
+    if (audio_sink != nullptr) gst_object_unref(audio_sink);
+
+    // Audio output is chosen when play-bin is built, the tap may have been turned on or off since
+    if (tapped != (player.mAudioCaps != nullptr))
+        return false;
+
+    if (tapped)
+    {
+        GstAppSink *audio_app_sink = nullptr;
+        g_object_get(player.mPipeline, "audio-sink", &audio_app_sink, nullptr);
+        BIND_TO_SCOPE(audio_app_sink);
+
+        GstCaps *caps = gst_caps_from_string(player.mAudioCaps);
+        gst_app_sink_set_caps(scoped_audio_app_sink.pointer, caps);
+        gst_caps_unref(caps);
+    }
+
+    GstAppSink *app_sink = nullptr;
+    g_object_get(player.mPipeline, "video-sink", &app_sink, nullptr);
+
+    if (app_sink == nullptr)
+    {
+        // Built for audio only, cannot hand off video frames
+        return !discoverer.getHasVideo();
+    }
+
+    BIND_TO_SCOPE(app_sink);
+
+    GstElement *crop = nullptr;
+    g_object_get(player.mPipeline, "video-filter", &crop, nullptr);
+
+    if (crop != nullptr)
+    {
+        applyCrop(player, crop);
+        gst_object_unref(crop);
+    }
+
+    if (discoverer.getHasVideo())
+    {
+        gchar* caps_str = videoCaps(width, height, fmt);
+        BIND_TO_SCOPE(caps_str);
+
+        GstCaps *caps = gst_caps_from_string(scoped_caps_str.pointer);
+        gst_app_sink_set_caps(scoped_app_sink.pointer, caps);
+        gst_caps_unref(caps);
+    }
+
+    // Pipeline is in READY here, URI can be swapped without rebuilding anything
+    g_object_set(player.mPipeline,
+        "uri",      discoverer.getUri(),
+        "volume",   player.mVolume,
+        nullptr);
+
+    return true;
+}
+
+void Internal::releasePipeline(Player& player)
+{
+    watchBus(player, false);
+
+    if (player.mPipeline != nullptr)
+    {
+        gst_element_set_state(player.mPipeline, GST_STATE_NULL);
+        gst_object_unref(player.mPipeline);
+        player.mPipeline = nullptr;
+    }
+
+    if (player.mGstBus != nullptr)
+    {
+        gst_object_unref(player.mGstBus);
+        player.mGstBus = nullptr;
+    }
+}
+
+void Internal::applyCrop(const Player& player, GstElement* crop)
+{
+    // A crop set for another media may not fit this one, it would fail negotiation
+    const bool fits =
+        (player.mSourceWidth <= 0 || player.mCrop[0] + player.mCrop[2] < player.mSourceWidth) &&
+        (player.mSourceHeight <= 0 || player.mCrop[1] + player.mCrop[3] < player.mSourceHeight);
+
+    if (!fits)
+        g_debug("Crop does not fit a %dx%d video, it is not cropped.", player.mSourceWidth, player.mSourceHeight);
+
+    // Safe while playing, videocrop renegotiates with the scaler on its next buffer
+    g_object_set(crop,
+        "left",     fits ? player.mCrop[0] : 0,
+        "top",      fits ? player.mCrop[1] : 0,
+        "right",    fits ? player.mCrop[2] : 0,
+        "bottom",   fits ? player.mCrop[3] : 0,
+        nullptr);
+}
+
+void Internal::onAboutToFinish(GstElement* playbin, Player* player)
+{
+    g_mutex_lock(&player->mPlaylistLock);
+
+    gchar* current_uri = nullptr;
+    g_object_get(playbin, "current-uri", &current_uri, nullptr);
+
+    gchar* next_uri = static_cast<gchar*>(g_queue_pop_head(&player->mPlaylist));
+
+    if (player->mLoop && !isNullOrEmpty(current_uri))
+    {
+        // Looping a play list plays the finished media again after the rest
+        if (next_uri == nullptr)
+            next_uri = g_strdup(current_uri);
+        else
+            g_queue_push_tail(&player->mPlaylist, g_strdup(current_uri));
+    }
+
+    if (next_uri != nullptr)
+    {
+        g_object_set(playbin, "uri", next_uri, nullptr);
+        g_free(player->mNextTrackUri);
+        player->mNextTrackUri = next_uri;
+    }
+
+    g_free(current_uri);
+    g_mutex_unlock(&player->mPlaylistLock);
+}
+
+void Internal::processTrackChange(Player& player)
+{
+    g_mutex_lock(&player.mPlaylistLock);
+
+    gchar* next_uri = player.mNextTrackUri;
+    player.mNextTrackUri = nullptr;
+
+    if (next_uri != nullptr)
+    {
+        g_free(player.mTrackUri);
+        player.mTrackUri = next_uri;
+    }
+
+    g_mutex_unlock(&player.mPlaylistLock);
+
+    // First stream of an open(...) is not a track change
+    if (next_uri != nullptr)
+    {
+        processDuration(player);
+        player.onTrackChanged(player.getUri());
+    }
+}
+
+void Internal::clearPlaylist(Player& player)
+{
+    player.clearQueue();
+
+    g_mutex_lock(&player.mPlaylistLock);
+    g_free(player.mTrackUri);
+    g_free(player.mNextTrackUri);
+    player.mTrackUri        = nullptr;
+    player.mNextTrackUri    = nullptr;
+    g_mutex_unlock(&player.mPlaylistLock);
+}
+
+bool Internal::preparePipeline(Player& player, const Discoverer& discoverer, gint width, gint height, const gchar* fmt)
+{
+    if (!discoverer.getHasVideo() && !discoverer.getHasAudio())
+    {
+        player.onError("Media provided does not contain neither audio nor video.");
+        return false;
+    }
+
+    // Crop is checked against the decoded size, before any scaling
+    player.mSourceWidth  = discoverer.getHasVideo() ? discoverer.getWidth() : 0;
+    player.mSourceHeight = discoverer.getHasVideo() ? discoverer.getHeight() : 0;
+
+    // A play-bin kept by close() only needs its URI and caps swapped
+    if (player.mPipeline != nullptr && !reusePipeline(player, discoverer, width, height, fmt))
+    {
+        releasePipeline(player);
+    }
+
+    if (player.mPipeline == nullptr && !buildPipeline(player, discoverer, width, height, fmt))
+    {
+        return false;
+    }
+
+    watchBus(player, player.mBusThread);
+
+    if (player.mPoolCount > 0 && discoverer.getHasVideo())
+    {
+        player.mBufferPool = newFramePool(player);
+    }
+
+    // Streaming threads read the decoder setup, so they get a copy settings can't change under
+    if (player.mDecoderSetup != nullptr) g_hash_table_destroy(player.mDecoderSetup);
+    player.mDecoderSetup = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    player.mSetupThreads = player.mDecoderThreads;
+    player.mSetupConvert = player.mConvert;
+
+    GHashTableIter iter;
+    gpointer key = nullptr, value = nullptr;
+    g_hash_table_iter_init(&iter, player.mDecoderProps);
+
+    while (g_hash_table_iter_next(&iter, &key, &value) != FALSE)
+    {
+        g_hash_table_insert(player.mDecoderSetup, g_strdup(static_cast<const gchar*>(key)), g_strdup(static_cast<const gchar*>(value)));
+    }
+
+    if (discoverer.getHasVideo())
+    {
+        GstElement *video_sink = nullptr;
+        g_object_get(player.mPipeline, "video-sink", &video_sink, nullptr);
+
+        if (video_sink != nullptr)
+        {
+            // Sink hands frames off early, update(vblank) presents them on time
+            g_object_set(video_sink, "ts-offset", gint64(-player.mFrameLead * GST_SECOND), nullptr);
+            g_object_set(video_sink, "sync", player.mSync ? TRUE : FALSE, nullptr);
+            gst_object_unref(video_sink);
+        }
+
+        player.mFrameQueue = new FrameQueue(player.mQueuePolicy, player.mQueueDepth,
+            &player.mDroppedFrames[player.mQueuePolicy], player.mCounters);
+    }
+
+    g_mutex_lock(&player.mPlaylistLock);
+    player.mTrackUri = g_strdup(discoverer.getUri());
+    g_mutex_unlock(&player.mPlaylistLock);
+
+    player.mDuration = discoverer.getDuration();
+    return true;
+}
+
+bool Internal::open(Player& player, const gchar* path, gint width, gint height, const gchar* fmt)
+{
+    TRACE_SCOPE("open");
+    if (!gstreamerInitialized())
+    {
+        player.onError("You cannot open a media with ngw.");
+        return false;
+    }
+
+    // First close any current streams.
+    player.close();
+
+    if (isNullOrEmpty(path))
+    {
+        player.onError("Supplied media path is empty.");
+        return false;
+    }
+
+    // Probed once, the overloads without a size take it from this discovery too
+    Discoverer discoverer;
+    if (!discoverer.open(path))
+    {
+        return false;
+    }
+
+    if (width <= 0)  width  = discoverer.getWidth();
+    if (height <= 0) height = discoverer.getHeight();
+
+    if (!preparePipeline(player, discoverer, width, height, fmt))
+    {
+        return false;
+    }
+
+    // Going from NULL => READY => PAUSE forces the
+    // pipeline to pre-roll so we can get video dim
+    GstState state;
+
+    gst_element_set_state(player.mPipeline, GST_STATE_READY);
+    if (gst_element_get_state(player.mPipeline, &state, nullptr, 10 * GST_SECOND) == GST_STATE_CHANGE_FAILURE ||
+        state != GST_STATE_READY)
+    {
+        player.onError("Failed to put pipeline in READY state.");
+        return false;
+    }
+
+    gst_element_set_state(player.mPipeline, GST_STATE_PAUSED);
+    if (gst_element_get_state(player.mPipeline, &state, nullptr, 10 * GST_SECOND) == GST_STATE_CHANGE_FAILURE ||
+        state != GST_STATE_PAUSED)
+    {
+        player.onError("Failed to put pipeline in PAUSE state.");
+        return false;
+    }
+
+    return true;
+}
+
+GThreadPool* Internal::openPool()
+{
+    // Shared by all players, so a dozen of them opening at once overlap
+    static GThreadPool* pool = g_thread_pool_new(&Internal::discoverOpen, nullptr,
+        gint(MAX(g_get_num_processors(), 1u)), FALSE, nullptr);
+    return pool;
+}
+
+void Internal::discoverOpen(gpointer data, gpointer)
+{
+    OpenTask* task = static_cast<OpenTask*>(data);
+
+    if (g_atomic_int_get(&task->canceled) == FALSE)
+    {
+        task->success = task->discoverer.open(task->path);
+    }
+
+    g_atomic_int_set(&task->done, TRUE);
+    unref(task);
+}
+
+void Internal::processOpen(Player& player)
+{
+    OpenTask* task = player.mOpenTask;
+    player.mOpenTask = nullptr;
+
+    const Discoverer& discoverer = task->discoverer;
+    bool success = task->success;
+
+    if (!success)
+    {
+        player.onError("Unable to discover the media.");
+    }
+    else
+    {
+        gint width  = task->width > 0 ? task->width : discoverer.getWidth();
+        gint height = task->height > 0 ? task->height : discoverer.getHeight();
+        success = preparePipeline(player, discoverer, width, height, task->format);
+    }
+
+    // Pre-roll finishes in the background, ASYNC_DONE completes the open
+    GstStateChangeReturn ret = success ? gst_element_set_state(player.mPipeline, GST_STATE_PAUSED) : GST_STATE_CHANGE_FAILURE;
+    if (success && ret == GST_STATE_CHANGE_FAILURE)
+    {
+        player.onError("Failed to put pipeline in PAUSE state.");
+        success = false;
+    }
+
+    unref(task);
+
+    if (!success)
+    {
+        player.onOpened(false);
+    }
+    else if (ret == GST_STATE_CHANGE_ASYNC)
+    {
+        player.mOpening = true;
+    }
+    else
+    {
+        // Reached PAUSED right away (or a live source that does not pre-roll), no ASYNC_DONE follows
+        player.mOpening = false;
+        player.onOpened(true);
+    }
+}
+
+void Internal::cancelOpen(Player& player)
+{
+    if (player.mOpenTask != nullptr)
+    {
+        // Worker drops its reference once it is done with the discovery
+        g_atomic_int_set(&player.mOpenTask->canceled, TRUE);
+        unref(player.mOpenTask);
+        player.mOpenTask = nullptr;
+    }
+
+    player.mOpening = false;
+}
+
+void Internal::unref(OpenTask* task)
+{
+    if (g_atomic_int_dec_and_test(&task->refs))
+    {
+        g_free(task->path);
+        g_free(task->format);
+        delete task;
+    }
+}
+
+gpointer Internal::discoverMedia(gpointer data)
+{
+    DiscovererBatch* batch = static_cast<DiscovererBatch*>(data);
+    DiscoveryTask* current = nullptr;
+
+    // Async discoverers dispatch on the thread default context of where they are started
+    GMainContext* context = g_main_context_new();
+    g_main_context_push_thread_default(context);
+
+    GstDiscoverer* discoverer = gst_discoverer_new(DISCOVER_TIMEOUT, nullptr);
+    if (discoverer != nullptr)
+    {
+        g_signal_connect(discoverer, "discovered", G_CALLBACK(&Internal::onDiscovered), &current);
+        gst_discoverer_start(discoverer);
+    }
+
+    for (;;)
+    {
+        gpointer path = g_async_queue_pop(batch->mPaths);
+        if (path == batch) break;
+
+        DiscoveryTask* task = new DiscoveryTask();
+        task->discoverer.mMediaUri = processPath(static_cast<const gchar*>(path));
+        g_free(path);
+
+        const gchar* uri = task->discoverer.mMediaUri;
+        if (isNullOrEmpty(uri))
+        {
+            task->success = false;
+        }
+        else if (DiscoveryCache::get().lookup(uri, task->discoverer))
+        {
+            task->success = true;
+        }
+        else if (discoverer != nullptr && gst_discoverer_discover_uri_async(discoverer, uri) != FALSE)
+        {
+            current = task;
+            while (!task->done) g_main_context_iteration(context, TRUE);
+            current = nullptr;
+
+            if (task->success) DiscoveryCache::get().store(task->discoverer, false);
+        }
+
+        g_async_queue_push(batch->mResults, task);
+    }
+
+    if (discoverer != nullptr)
+    {
+        gst_discoverer_stop(discoverer);
+        g_object_unref(discoverer);
+    }
+
+    g_main_context_pop_thread_default(context);
+    g_main_context_unref(context);
+    return nullptr;
+}
+
+void Internal::onDiscovered(GstDiscoverer*, GstDiscovererInfo* info, GError*, DiscoveryTask** task)
+{
+    if (*task == nullptr) return;
+
+    (*task)->success = fill((*task)->discoverer, info);
+    (*task)->done = true;
+}
+
+void Internal::processDiscovery(DiscovererBatch& batch, gpointer data)
+{
+    DiscoveryTask* task = static_cast<DiscoveryTask*>(data);
+    batch.onDiscovered(task->discoverer, task->success);
+    delete task;
+
+    if (g_atomic_int_dec_and_test(&batch.mPending))
+        DiscoveryCache::get().flush();
+}
+
+gpointer Internal::extractThumbnails(gpointer data)
+{
+    Thumbnailer* thumbnailer = static_cast<Thumbnailer*>(data);
+
+    gchar* pipeline_cmd = g_strdup_printf(
+        "playbin uri=\"%s\" flags=0x00000001 video-sink=\""
+        "appsink sync=no enable-last-sample=no caps=%s\"",
+        thumbnailer->mDiscoverer.getUri(),
+        thumbnailer->mCaps);
+    BIND_TO_SCOPE(pipeline_cmd);
+
+    // Video only play-bin, pre-rolled frames are pulled after each seek
+    GstElement* pipeline = gst_parse_launch(scoped_pipeline_cmd.pointer, nullptr);
+    GstAppSink* app_sink = nullptr;
+    bool prerolled = false;
+
+    if (pipeline != nullptr)
+    {
+        g_object_get(pipeline, "video-sink", &app_sink, nullptr);
+        gst_element_set_state(pipeline, GST_STATE_PAUSED);
+        prerolled = gst_element_get_state(pipeline, nullptr, nullptr, DISCOVER_TIMEOUT) == GST_STATE_CHANGE_SUCCESS;
+    }
+
+    for (;;)
+    {
+        gpointer request = g_async_queue_pop(thumbnailer->mRequests);
+        if (request == thumbnailer) break;
+
+        ThumbnailTask* task = static_cast<ThumbnailTask*>(request);
+
+        if (prerolled && app_sink != nullptr &&
+            gst_element_seek_simple(pipeline, GST_FORMAT_TIME,
+                GstSeekFlags(GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_ACCURATE),
+                gint64(task->time * GST_SECOND)) != FALSE &&
+            gst_element_get_state(pipeline, nullptr, nullptr, DISCOVER_TIMEOUT) == GST_STATE_CHANGE_SUCCESS)
+        {
+            if (GstSample* sample = gst_app_sink_pull_preroll(app_sink))
+            {
+                mapSample(task->frame, sample);
+            }
+        }
+
+        g_async_queue_push(thumbnailer->mResults, task);
+    }
+
+    if (app_sink != nullptr)
+    {
+        g_object_unref(app_sink);
+    }
+
+    if (pipeline != nullptr)
+    {
+        gst_element_set_state(pipeline, GST_STATE_NULL);
+        gst_object_unref(pipeline);
+    }
+
+    return nullptr;
+}
+
+void Internal::processThumbnail(Thumbnailer& thumbnailer, gpointer data)
+{
+    ThumbnailTask* task = static_cast<ThumbnailTask*>(data);
+
+    if (task->frame.isValid())
+    {
+        thumbnailer.onThumbnail(task->time, task->frame);
+    }
+    else
+    {
+        gchar* msg = g_strdup_printf("Unable to extract a frame at %f seconds.", task->time);
+        BIND_TO_SCOPE(msg);
+        thumbnailer.onError(scoped_msg.pointer);
+    }
+
+    delete task;
+    g_atomic_int_add(&thumbnailer.mPending, -1);
+}
+
+void Internal::slave(PlayerGroup& group, Player& player)
+{
+    if (player.mPipeline == nullptr) return;
+
+    // Without a start time, pipeline leaves base time to the group
+    gst_pipeline_use_clock(GST_PIPELINE(player.mPipeline), group.mClock);
+    gst_element_set_start_time(player.mPipeline, GST_CLOCK_TIME_NONE);
+}
+
+void Internal::unslave(Player& player)
+{
+    if (player.mPipeline == nullptr) return;
+
+    gst_pipeline_auto_clock(GST_PIPELINE(player.mPipeline));
+    gst_element_set_start_time(player.mPipeline, 0);
+}
+
+bool Internal::isOpen(const Player& player)
+{
+    return player.mPipeline != nullptr;
+}
+
+void Internal::start(Player& player, GstClockTime base_time)
+{
+    if (player.mPipeline == nullptr) return;
+
+    gst_element_set_base_time(player.mPipeline, base_time);
+    player.play();
+}
+
+void Internal::seek(Player& player, gdouble time)
+{
+    if (player.mPipeline == nullptr) return;
+
+    TRACE_SCOPE("seek");
+
+    // Same as Player::setTime(...) but not coalesced, the group waits for it
+    if (player.mFrameQueue != nullptr) player.mFrameQueue->setFlushing(true);
+
+    gst_element_seek_simple(
+        player.mPipeline,
+        GST_FORMAT_TIME,
+        GstSeekFlags(
+            GST_SEEK_FLAG_FLUSH |
+            GST_SEEK_FLAG_ACCURATE),
+        gint64(CLAMP(time, 0, player.mDuration) * GST_SECOND));
+
+    if (player.mFrameQueue != nullptr) player.mFrameQueue->setFlushing(false);
+}
+
+void Internal::preroll(Player& player)
+{
+    if (player.mPipeline == nullptr) return;
+    gst_element_get_state(player.mPipeline, nullptr, nullptr, DISCOVER_TIMEOUT);
+}
+
+void Internal::reset(Frame& frame)
+{
+    frame.mSample  = nullptr;
+    frame.mBuffer  = nullptr;
+    frame.mMapInfo = GstMapInfo();
+    frame.mInfo    = FrameInfo();
+}
+
+void Internal::load(Discoverer& discoverer, GKeyFile* key_file, const gchar* uri)
+{
+    reset(discoverer);
+
+    discoverer.mMediaUri   = g_strdup(uri);
+    discoverer.mWidth      = g_key_file_get_integer(key_file, uri, "width", nullptr);
+    discoverer.mHeight     = g_key_file_get_integer(key_file, uri, "height", nullptr);
+    discoverer.mFrameRate  = gfloat(g_key_file_get_double(key_file, uri, "frame-rate", nullptr));
+    discoverer.mDuration   = g_key_file_get_double(key_file, uri, "duration", nullptr);
+    discoverer.mSampleRate = guint(g_key_file_get_integer(key_file, uri, "sample-rate", nullptr));
+    discoverer.mBitRate    = guint(g_key_file_get_integer(key_file, uri, "bit-rate", nullptr));
+    discoverer.mHasVideo   = g_key_file_get_boolean(key_file, uri, "has-video", nullptr) != FALSE;
+    discoverer.mHasAudio   = g_key_file_get_boolean(key_file, uri, "has-audio", nullptr) != FALSE;
+    discoverer.mSeekable   = g_key_file_get_boolean(key_file, uri, "seekable", nullptr) != FALSE;
+}
+
+void Internal::save(const Discoverer& discoverer, GKeyFile* key_file, const gchar* uri)
+{
+    g_key_file_set_integer(key_file, uri, "width", discoverer.mWidth);
+    g_key_file_set_integer(key_file, uri, "height", discoverer.mHeight);
+    g_key_file_set_double(key_file, uri, "frame-rate", discoverer.mFrameRate);
+    g_key_file_set_double(key_file, uri, "duration", discoverer.mDuration);
+    g_key_file_set_integer(key_file, uri, "sample-rate", gint(discoverer.mSampleRate));
+    g_key_file_set_integer(key_file, uri, "bit-rate", gint(discoverer.mBitRate));
+    g_key_file_set_boolean(key_file, uri, "has-video", discoverer.mHasVideo);
+    g_key_file_set_boolean(key_file, uri, "has-audio", discoverer.mHasAudio);
+    g_key_file_set_boolean(key_file, uri, "seekable", discoverer.mSeekable);
+}
+
+bool Internal::gstreamerInitialized()
+{
+    GError *init_error = nullptr;
+    BIND_TO_SCOPE(init_error);
+
+    if (gst_is_initialized() == FALSE &&
+        gst_init_check(nullptr, nullptr, &init_error) == FALSE) {
+        g_debug("GStreamer failed to initialize: %s.", scoped_init_error.pointer->message);
+        return false;
+    } else {
+        return true;
+    }
+}
+
+GstFlowReturn Internal::onPreroll(GstElement* appsink, ngw::Player* player)
+{
+    GstSample* sample = gst_app_sink_pull_preroll(GST_APP_SINK(appsink));
+
+    // Here's our chance to get the actual dimension of the media.
+    // The actual dimension might be slightly different from what
+    // is passed into and requested from the pipeline.
+    if (sample != nullptr)
+    {
+        if (GstCaps *caps = gst_sample_get_caps(sample))
+        {
+            if (gst_caps_is_fixed(caps) != FALSE)
+            {
+                if (const GstStructure *str = gst_caps_get_structure(caps, 0))
+                {
+                    if (gst_structure_get_int(str, "width", &player->mWidth) == FALSE ||
+                        gst_structure_get_int(str, "height", &player->mHeight) == FALSE)
+                    {
+                        player->onError("No width/height information available.");
+                    }
+                }
+            }
+            else
+            {
+                player->onError("caps is not fixed for this media.");
+            }
+        }
+    }
+
+    // Not synchronized against the clock yet, no presentation time to report
+    processSample(player, sample, nullptr);
+    return GST_FLOW_OK;
+}
+
+GstFlowReturn Internal::onSampled(GstElement* appsink, ngw::Player* player)
+{
+    processSample(player, gst_app_sink_pull_sample(GST_APP_SINK(appsink)), appsink);
+    return GST_FLOW_OK;
+}
+
+GstFlowReturn Internal::onAudioSampled(GstElement* appsink, ngw::Player* player)
+{
+    GstSample* sample = gst_app_sink_pull_sample(GST_APP_SINK(appsink));
+    if (sample == nullptr) return GST_FLOW_OK;
+
+    TRACE_SCOPE("processAudio");
+
+    GstBuffer* buffer = gst_sample_get_buffer(sample);
+    AudioRing* ring = static_cast<AudioRing*>(g_atomic_pointer_get(&player->mAudioRing));
+    GstMapInfo map;
+
+    if (buffer != nullptr && ring != nullptr && gst_buffer_map(buffer, &map, GST_MAP_READ) != FALSE)
+    {
+        // Engine is not pulling fast enough, newest samples are dropped rather than blocking the clock
+        if (ring->push(map.data, map.size) > 0)
+        {
+            g_debug("Audio tap ring is full, samples are dropped.");
+        }
+
+        gst_buffer_unmap(buffer, &map);
+    }
+
+    gst_sample_unref(sample);
+    return GST_FLOW_OK;
+}
+
+GstPadProbeReturn Internal::onAudioFlush(GstPad*, GstPadProbeInfo* info, gpointer player)
+{
+    AudioRing* ring = static_cast<AudioRing*>(g_atomic_pointer_get(&static_cast<Player*>(player)->mAudioRing));
+
+    if (ring != nullptr && GST_EVENT_TYPE(GST_PAD_PROBE_INFO_EVENT(info)) == GST_EVENT_FLUSH_STOP)
+        ring->flush();
+
+    return GST_PAD_PROBE_OK;
+}
+
+void Internal::freeAudioRing(gpointer ring)
+{
+    delete static_cast<AudioRing*>(ring);
+}
+
+void Internal::processSample(ngw::Player *const player, GstSample* const sample, GstElement* const sink)
+{
+    g_return_if_fail(sample != nullptr);
+
+    TRACE_SCOPE("processSample");
+
+    if (player->mFrameQueue == nullptr)
+    {
+        gst_sample_unref(sample);
+        return;
+    }
+
+    player->mCounters->add(player->mCounters->received);
+
+    // Acquire and hold onto the new frame (until UI consumes it)
+    Frame* frame = new Frame();
+    if (mapSample(*frame, sample))
+    {
+        describe(*player, *frame, sink);
+        player->mFrameQueue->push(frame);
+    }
+    else
+    {
+        delete frame;
+        player->mCounters->add(player->mCounters->dropped[FRAME_DROP_MAP]);
+    }
+}
+
+bool Internal::mapSample(Frame& frame, GstSample* sample)
+{
+    frame.release();
+    g_return_val_if_fail(sample != nullptr, false);
+
+    GstBuffer* buffer = gst_sample_get_buffer(sample);
+    if (buffer == nullptr || gst_buffer_map(buffer, &frame.mMapInfo, GST_MAP_READ) == FALSE)
+    {
+        gst_sample_unref(sample);
+        return false;
+    }
+
+    // Frame takes ownership of the sample reference
+    frame.mSample = sample;
+    frame.mBuffer = buffer;
+    return true;
+}
+
+void Internal::describe(Player& player, Frame& frame, GstElement* sink)
+{
+    FrameInfo& info = frame.mInfo;
+
+    layout(frame, info.layout);
+    info.sequence       = ++player.mFrameCount;
+    info.arrivalTime    = g_get_monotonic_time();
+    info.pts            = GST_BUFFER_PTS(frame.mBuffer);
+    info.duration       = GST_BUFFER_DURATION(frame.mBuffer);
+
+    const GstSegment* segment = gst_sample_get_segment(frame.mSample);
+    if (segment != nullptr && GST_CLOCK_TIME_IS_VALID(info.pts))
+        info.runningTime = gst_segment_to_running_time(segment, GST_FORMAT_TIME, info.pts);
+
+    if (sink == nullptr || !GST_CLOCK_TIME_IS_VALID(info.runningTime))
+        return;
+
+    if (GstClock *clock = gst_element_get_clock(sink))
+    {
+        // Clock time the sink synchronizes this frame against, relative to now
+        const GstClockTimeDiff due =
+            GstClockTimeDiff(gst_element_get_base_time(sink) + info.runningTime) -
+            GstClockTimeDiff(gst_clock_get_time(clock));
+
+        info.presentTime = info.arrivalTime + due / GstClockTimeDiff(GST_USECOND);
+        gst_object_unref(clock);
+    }
+}
+
+void Internal::copyInfo(Frame& dst, const Frame& src)
+{
+    dst.mInfo = src.mInfo;
+
+    // Plane pointers follow the mapping of the destination
+    for (guint plane = 0; plane < dst.mInfo.layout.planes; ++plane)
+    {
+        dst.mInfo.layout.data[plane] = dst.mMapInfo.data + dst.mInfo.layout.offset[plane];
+    }
+}
+
+bool Internal::layout(const Frame& frame, FrameLayout& layout)
+{
+    layout = FrameLayout();
+    if (!frame.isValid())
+        return false;
+
+    GstVideoInfo info;
+    if (gst_video_info_from_caps(&info, gst_sample_get_caps(frame.mSample)) == FALSE)
+        return false;
+
+    layout.format   = gst_video_format_to_string(GST_VIDEO_INFO_FORMAT(&info));
+    layout.width    = GST_VIDEO_INFO_WIDTH(&info);
+    layout.height   = GST_VIDEO_INFO_HEIGHT(&info);
+    layout.planes   = GST_VIDEO_INFO_N_PLANES(&info);
+
+    // Decoder's own layout wins, caps only describe the default (tightly packed) one
+    if (const GstVideoMeta* meta = gst_buffer_get_video_meta(frame.mBuffer))
+    {
+        layout.planes = meta->n_planes;
+        for (guint plane = 0; plane < layout.planes; ++plane)
+        {
+            layout.offset[plane] = meta->offset[plane];
+            layout.stride[plane] = meta->stride[plane];
+        }
+    }
+    else
+    {
+        for (guint plane = 0; plane < layout.planes; ++plane)
+        {
+            layout.offset[plane] = GST_VIDEO_INFO_PLANE_OFFSET(&info, plane);
+            layout.stride[plane] = GST_VIDEO_INFO_PLANE_STRIDE(&info, plane);
+        }
+    }
+
+    for (guint plane = 0; plane < layout.planes; ++plane)
+    {
+        layout.data[plane] = frame.mMapInfo.data + layout.offset[plane];
+    }
+
+    return true;
+}
+
+GstPadProbeReturn Internal::onSinkQuery(GstPad*, GstPadProbeInfo* info, gpointer player)
+{
+    GstQuery* query = GST_PAD_PROBE_INFO_QUERY(info);
+    if (GST_QUERY_TYPE(query) != GST_QUERY_ALLOCATION)
+        return GST_PAD_PROBE_OK;
+
+    // appsink does not answer allocation queries, advertise video meta on its behalf for users reading the layout
+    if (static_cast<Player*>(player)->mPaddedFrames)
+        gst_query_add_allocation_meta(query, GST_VIDEO_META_API_TYPE, nullptr);
+
+    FramePool* pool = reinterpret_cast<FramePool*>(static_cast<Player*>(player)->mBufferPool);
+    if (pool == nullptr)
+        return GST_PAD_PROBE_OK;
+
+    GstCaps* caps = nullptr;
+    GstVideoInfo video_info;
+    gst_query_parse_allocation(query, &caps, nullptr);
+
+    // Last element upstream (videoconvert, videoscale) writes frames straight into caller's memory
+    if (caps != nullptr && gst_video_info_from_caps(&video_info, caps) != FALSE && video_info.size <= pool->size)
+        gst_query_add_allocation_pool(query, GST_BUFFER_POOL(pool), guint(video_info.size), pool->count, pool->count);
+
+    return GST_PAD_PROBE_OK;
+}
+
+GType Internal::framePoolType()
+{
+    static GType type = g_type_register_static_simple(GST_TYPE_BUFFER_POOL, "NgwFramePool",
+        sizeof(FramePoolClass), &Internal::initFramePoolClass,
+        sizeof(FramePool), &Internal::initFramePool, GTypeFlags(0));
+    return type;
+}
+
+GQuark Internal::framePoolQuark()
+{
+    static GQuark quark = g_quark_from_static_string("ngw-frame-pool-index");
+    return quark;
+}
+
+void Internal::initFramePoolClass(gpointer klass, gpointer)
+{
+    G_OBJECT_CLASS(klass)->finalize             = &Internal::finalizeFramePool;
+    GST_BUFFER_POOL_CLASS(klass)->alloc_buffer  = &Internal::allocFrameBuffer;
+    GST_BUFFER_POOL_CLASS(klass)->free_buffer   = &Internal::freeFrameBuffer;
+}
+
+void Internal::initFramePool(GTypeInstance* instance, gpointer)
+{
+    FramePool* pool = reinterpret_cast<FramePool*>(instance);
+
+    g_mutex_init(&pool->lock);
+    pool->buffers   = nullptr;
+    pool->used      = nullptr;
+    pool->count     = 0;
+    pool->size      = 0;
+}
+
+void Internal::finalizeFramePool(GObject* object)
+{
+    FramePool* pool = reinterpret_cast<FramePool*>(object);
+
+    g_mutex_clear(&pool->lock);
+    g_free(pool->buffers);
+    g_free(pool->used);
+
+    G_OBJECT_CLASS(g_type_class_peek(GST_TYPE_BUFFER_POOL))->finalize(object);
+}
+
+GstFlowReturn Internal::allocFrameBuffer(GstBufferPool* buffer_pool, GstBuffer** buffer, GstBufferPoolAcquireParams*)
+{
+    FramePool* pool = reinterpret_cast<FramePool*>(buffer_pool);
+
+    guint size = 0;
+    GstStructure* config = gst_buffer_pool_get_config(buffer_pool);
+    gst_buffer_pool_config_get_params(config, nullptr, &size, nullptr, nullptr);
+    gst_structure_free(config);
+
+    if (size > pool->size)
+        return GST_FLOW_ERROR;
+
+    g_mutex_lock(&pool->lock);
+
+    guint index = 0;
+    while (index < pool->count && pool->used[index] != FALSE) ++index;
+    if (index < pool->count) pool->used[index] = TRUE;
+
+    g_mutex_unlock(&pool->lock);
+
+    // Upstream asked for more buffers than the caller registered
+    if (index == pool->count)
+        return GST_FLOW_ERROR;
+
+    *buffer = gst_buffer_new_wrapped_full(GstMemoryFlags(0), pool->buffers[index], pool->size, 0, size, nullptr, nullptr);
+    gst_mini_object_set_qdata(GST_MINI_OBJECT(*buffer), framePoolQuark(), GUINT_TO_POINTER(index + 1), nullptr);
+    return GST_FLOW_OK;
+}
+
+void Internal::freeFrameBuffer(GstBufferPool* buffer_pool, GstBuffer* buffer)
+{
+    FramePool* pool = reinterpret_cast<FramePool*>(buffer_pool);
+    const guint tag = GPOINTER_TO_UINT(gst_mini_object_get_qdata(GST_MINI_OBJECT(buffer), framePoolQuark()));
+
+    g_mutex_lock(&pool->lock);
+    if (tag > 0 && tag <= pool->count) pool->used[tag - 1] = FALSE;
+    g_mutex_unlock(&pool->lock);
+
+    GST_BUFFER_POOL_CLASS(g_type_class_peek(GST_TYPE_BUFFER_POOL))->free_buffer(buffer_pool, buffer);
+}
+
+GstBufferPool* Internal::newFramePool(const Player& player)
+{
+    FramePool* pool = static_cast<FramePool*>(g_object_new(framePoolType(), nullptr));
+
+    pool->buffers   = g_new(guchar*, player.mPoolCount);
+    pool->used      = g_new0(gboolean, player.mPoolCount);
+    pool->count     = player.mPoolCount;
+    pool->size      = player.mPoolSize;
+
+    for (guint index = 0; index < pool->count; ++index)
+        pool->buffers[index] = player.mPoolBuffers[index];
+
+    // Pool objects start out floating
+    gst_object_ref_sink(pool);
+    return GST_BUFFER_POOL(pool);
+}
+
+void Internal::processDuration(Player& player)
+{
+    g_return_if_fail(player.mPipeline != nullptr);
+
+    const gdouble duration = queryDuration(player.mPipeline);
+    if (duration >= 0.) {
+        player.mDuration = duration;
+    }
+}
+
+gdouble Internal::queryDuration(GstElement* pipeline)
+{
+    // Nanoseconds
+    gint64 duration_ns = 0;
+    if (gst_element_query_duration(pipeline, GST_FORMAT_TIME, &duration_ns) != FALSE) {
+        // Seconds
+        return duration_ns / gdouble(GST_SECOND);
+    }
+
+    return -1.;
+}
+
+bool Internal::parse(const Player& player, GstMessage* msg, BusEvent& event)
+{
+    player.mCounters->add(player.mCounters->messages);
+    event.type = GST_MESSAGE_TYPE(msg);
+
+    switch (event.type)
+    {
+    case GST_MESSAGE_ERROR:
+    {
+        GError *err = nullptr;
+        BIND_TO_SCOPE(err);
+        gst_message_parse_error(msg, &err, nullptr);
+        event.error = g_strdup(scoped_err.pointer->message);
+    }
+    return true;
+
+    case GST_MESSAGE_STATE_CHANGED:
+    {
+        if (GST_MESSAGE_SRC(msg) != GST_OBJECT(player.mPipeline))
+            return false;
+
+        gst_message_parse_state_changed(msg, &event.oldState, &event.newState, nullptr);
+    }
+    return true;
+
+    case GST_MESSAGE_ASYNC_DONE:
+    case GST_MESSAGE_DURATION_CHANGED:
+    {
+        event.duration = queryDuration(player.mPipeline);
+    }
+    return true;
+
+    case GST_MESSAGE_STREAM_START:
+        return GST_MESSAGE_SRC(msg) == GST_OBJECT(player.mPipeline);
+
+    case GST_MESSAGE_EOS:
+        return true;
+
+    case GST_MESSAGE_QOS:
+    {
+        // Video sink and decoders post one for every frame they discard for being late
+        if (isVideoElement(GST_MESSAGE_SRC(msg)))
+            player.mCounters->add(player.mCounters->dropped[FRAME_DROP_LATE]);
+    }
+    return false;
+
+    default:
+        return false;
+    }
+}
+
+bool Internal::isVideoElement(GstObject* object)
+{
+    if (object == nullptr || !GST_IS_ELEMENT(object))
+        return false;
+
+    // Player's app sinks are its video sink and the audio tap
+    if (GST_IS_APP_SINK(object))
+        return g_strcmp0(GST_OBJECT_NAME(object), AUDIO_SINK_NAME) != 0;
+
+    GstElementFactory *factory = gst_element_get_factory(GST_ELEMENT(object));
+    const gchar* klass = factory != nullptr ? gst_element_factory_get_metadata(factory, GST_ELEMENT_METADATA_KLASS) : nullptr;
+    return klass != nullptr && g_strrstr(klass, "Video") != nullptr;
+}
+
+bool Internal::dispatch(Player& player, const BusEvent& event)
+{
+    if (event.duration >= 0.)
+    {
+        player.mDuration = event.duration;
+    }
+
+    switch (event.type)
+    {
+    case GST_MESSAGE_ERROR:
+    {
+        player.onError(event.error);
+
+        if (player.mOpening)
+        {
+            player.mOpening = false;
+            player.onOpened(false);
+        }
+
+        player.close();
+    }
+    return false;
+
+    case GST_MESSAGE_STATE_CHANGED:
+    {
+        player.mState = event.newState;
+
+        if (event.oldState != event.newState)
+        {
+            player.onState(event.oldState);
+        }
+    }
+    break;
+
+    case GST_MESSAGE_ASYNC_DONE:
+    {
+        if (player.mOpening)
+        {
+            player.mOpening = false;
+            player.onOpened(true);
+        }
+
+        if (player.mSeekingLock)
+        {
+            const gint64 latency = g_get_monotonic_time() - player.mSeekStart;
+
+            player.mCounters->seeks++;
+            player.mCounters->seekLatency += latency;
+            player.mCounters->maxSeekLatency = MAX(player.mCounters->maxSeekLatency, latency);
+
+            if (Tracer::isEnabled())
+                Tracer::get().record("seeking", 'X', player.mSeekStart, latency);
+
+            player.mSeekingLock = false;
+            player.onSeeked(latency / gdouble(G_USEC_PER_SEC));
+        }
+
+        if (player.mPendingSeek >= 0.)
+        {
+            player.setTime(player.mPendingSeek);
+        }
+    }
+    break;
+
+    case GST_MESSAGE_STREAM_START:
+    {
+        processTrackChange(player);
+    }
+    break;
+
+    case GST_MESSAGE_EOS:
+    {
+        player.onStreamEnd();
+
+        if (player.getLoop())
+        {
+            player.replay();
+        }
+        else
+        {
+            player.pause();
+        }
+    }
+    break;
+
+    default:
+        break;
+    }
+
+    return true;
+}
+
+GMainContext* Internal::busContext()
+{
+    // Shared by all players, a single thread watches every bus for the life time of the process
+    static GMainContext* context = g_main_context_new();
+    static GThread* thread = g_thread_new("ngw-bus", &Internal::watchBuses, context);
+    return thread != nullptr ? context : nullptr;
+}
+
+gpointer Internal::watchBuses(gpointer context)
+{
+    GMainContext* bus_context = static_cast<GMainContext*>(context);
+    g_main_context_push_thread_default(bus_context);
+
+    for (;;)
+    {
+        g_main_context_iteration(bus_context, TRUE);
+    }
+
+    return nullptr;
+}
+
+void Internal::watchBus(Player& player, bool on)
+{
+    if (on == (player.mBusWatch != nullptr) || player.mGstBus == nullptr)
+        return;
+
+    if (on)
+    {
+        GMainContext* context = busContext();
+        if (context == nullptr)
+        {
+            g_debug("Bus thread is not available, bus is polled by update().");
+            return;
+        }
+
+        player.mBusWatch = gst_bus_create_watch(player.mGstBus);
+        g_source_set_callback(player.mBusWatch, GSourceFunc(&Internal::onBusMessage), &player, nullptr);
+        g_source_attach(player.mBusWatch, context);
+        return;
+    }
+
+    // Once destroyed under the lock, the bus thread no longer touches the player
+    g_mutex_lock(&player.mBusLock);
+    g_source_destroy(player.mBusWatch);
+    g_mutex_unlock(&player.mBusLock);
+
+    g_source_unref(player.mBusWatch);
+    player.mBusWatch = nullptr;
+    clearEvents(player);
+}
+
+gboolean Internal::onBusMessage(GstBus*, GstMessage* msg, Player* player)
+{
+    TRACE_SCOPE("onBusMessage");
+
+    g_mutex_lock(&player->mBusLock);
+
+    // Player might have stopped watching while this message was dispatched
+    if (g_source_is_destroyed(g_main_current_source()) == FALSE)
+    {
+        BusEvent* event = new BusEvent();
+        if (parse(*player, msg, *event))
+        {
+            do { event->next = static_cast<BusEvent*>(g_atomic_pointer_get(&player->mBusEvents)); }
+            while (g_atomic_pointer_compare_and_exchange(&player->mBusEvents, event->next, event) == FALSE);
+        }
+        else
+        {
+            delete event;
+        }
+    }
+
+    g_mutex_unlock(&player->mBusLock);
+    return TRUE;
+}
+
+BusEvent* Internal::takeEvents(Player& player)
+{
+    gpointer events = nullptr;
+
+    // Idle players cost a single atomic read
+    do { events = g_atomic_pointer_get(&player.mBusEvents); }
+    while (events != nullptr && g_atomic_pointer_compare_and_exchange(&player.mBusEvents, events, nullptr) == FALSE);
+
+    // Newest first, reverse to hand them off in order
+    BusEvent* ordered = nullptr;
+    for (BusEvent* event = static_cast<BusEvent*>(events); event != nullptr;)
+    {
+        BusEvent* next = event->next;
+        event->next = ordered;
+        ordered = event;
+        event = next;
+    }
+
+    return ordered;
+}
+
+void Internal::clearEvents(Player& player)
+{
+    // Under the lock, an event being parsed cannot land after this
+    g_mutex_lock(&player.mBusLock);
+    BusEvent* events = takeEvents(player);
+    g_mutex_unlock(&player.mBusLock);
+
+    while (BusEvent* event = events)
+    {
+        events = event->next;
+        delete event;
+    }
+}
+
+void Internal::processEvents(Player& player)
+{
+    TRACE_SCOPE("processEvents");
+
+    if (player.mOpenTask != nullptr && g_atomic_int_get(&player.mOpenTask->done) != FALSE)
+    {
+        processOpen(player);
+    }
+
+    if (player.mBusWatch != nullptr)
+    {
+        // Parsed on the bus thread, oldest first
+        BusEvent* events = takeEvents(player);
+        bool open = true;
+
+        while (BusEvent* event = events)
+        {
+            events = event->next;
+
+            // Once closed, the rest belongs to the closed media
+            open = open && dispatch(player, *event);
+            delete event;
+        }
+    }
+    else if (player.mGstBus != nullptr)
+    {
+        while (gst_bus_have_pending(player.mGstBus) != FALSE)
+        {
+            if (GstMessage* msg = gst_bus_pop(player.mGstBus))
+            {
+                BIND_TO_SCOPE(msg);
+
+                BusEvent event;
+                if (parse(player, scoped_msg.pointer, event) && !dispatch(player, event))
+                    break;
+            }
+        }
+    }
+}
+
+Frame* Internal::present(Player& player, gint64 vblank)
+{
+    if (player.mFrameQueue == nullptr)
+        return nullptr;
+
+    Frame* frame = vblank < 0 ? player.mFrameQueue->pop() : player.mFrameQueue->popDue(vblank);
+    if (frame != nullptr)
+    {
+        TRACE_SCOPE("onFrame");
+        PlayerCounters& counters = *player.mCounters;
+        const gint64 start = g_get_monotonic_time();
+
+        player.mCurrentFrame = frame;
+
+        player.onFrame(
+            frame->getData(),
+            frame->getSize());
+
+        player.onFrameInfo(
+            frame->getInfo(),
+            frame->getData(),
+            frame->getSize());
+
+        player.mCurrentFrame = nullptr;
+
+        const gint64 latency = start - frame->getInfo().arrivalTime;
+        const gint64 frame_time = g_get_monotonic_time() - start;
+
+        counters.delivered++;
+        counters.latency       += latency;
+        counters.maxLatency     = MAX(counters.maxLatency, latency);
+        counters.frameTime     += frame_time;
+        counters.maxFrameTime   = MAX(counters.maxFrameTime, frame_time);
+    }
+
+    // Caller frees resources of this frame
+    return frame;
+}
+
+bool Internal::isManaged(const PlayerManager& manager, const Player* player)
+{
+    for (guint index = 0; index < manager.mPlayers->len; ++index)
+    {
+        if (g_ptr_array_index(manager.mPlayers, index) == player) return true;
+    }
+
+    return false;
+}
+
+void Internal::snapshot(const Player& player, PlayerState& state, const Frame* frame)
+{
+    state.player    = &player;
+    state.state     = player.mState;
+    state.time      = isOpen(player) ? player.getTime() : 0.;
+    state.duration  = player.mDuration;
+    state.width     = player.mWidth;
+    state.height    = player.mHeight;
+    state.sequence  = frame != nullptr ? frame->getInfo().sequence : 0;
+}
+
+void Internal::processFrame(gpointer task, gpointer manager)
+{
+    ProcessTask* process = static_cast<ProcessTask*>(task);
+    PlayerManager* owner = static_cast<PlayerManager*>(manager);
+
+    owner->onProcess(*process->player, *process->frame);
+    delete process->frame;
+    delete process;
+
+    if (g_atomic_int_dec_and_test(&owner->mPending) != FALSE)
+    {
+        g_mutex_lock(&owner->mLock);
+        g_cond_signal(&owner->mCond);
+        g_mutex_unlock(&owner->mLock);
+    }
+}
+
+void Internal::onElementSetup(GstElement*, GstElement* element, Player* player)
+{
+    GstElementFactory *factory = gst_element_get_factory(element);
+    if (factory == nullptr) return;
+
+    const gchar* klass = gst_element_factory_get_metadata(factory, GST_ELEMENT_METADATA_KLASS);
+    if (klass == nullptr) return;
+
+    // videoconvert, videoscale or videoconvertscale, inside play-sink
+    if (g_strrstr(klass, "Converter") != nullptr && g_strrstr(klass, "Video") != nullptr)
+    {
+        setupConverter(element, player->mSetupConvert);
+        return;
+    }
+
+    if (g_strrstr(klass, "Decoder") == nullptr) return;
+
+    GObjectClass *object_class = G_OBJECT_GET_CLASS(element);
+
+    if (g_strrstr(klass, "Video") != nullptr)
+    {
+        guint threads = player->mSetupThreads;
+
+        // Decoder takes a share of the global budget until it is finalized
+        if (threads == 0 && (threads = DecoderPolicy::get().acquire()) > 0)
+        {
+            g_object_weak_ref(G_OBJECT(element), &Internal::releaseDecoder, GUINT_TO_POINTER(threads));
+        }
+
+        static const gchar* const THREAD_PROPS[] = { "max-threads", "threads", "n-threads" };
+
+        for (const gchar* name : THREAD_PROPS)
+        {
+            if (threads == 0 || g_object_class_find_property(object_class, name) == nullptr) continue;
+
+            gchar* value = g_strdup_printf("%u", threads);
+            gst_util_set_object_arg(G_OBJECT(element), name, value);
+            g_free(value);
+            break;
+        }
+    }
+
+    // Applied last, so they take precedence over the thread budget
+    GHashTableIter iter;
+    gpointer key = nullptr, value = nullptr;
+    g_hash_table_iter_init(&iter, player->mDecoderSetup);
+
+    while (g_hash_table_iter_next(&iter, &key, &value) != FALSE)
+    {
+        const gchar* name = static_cast<const gchar*>(key);
+        if (g_object_class_find_property(object_class, name) == nullptr) continue;
+
+        gst_util_set_object_arg(G_OBJECT(element), name, static_cast<const gchar*>(value));
+    }
+}
+
+void Internal::setupConverter(GstElement* element, const ConvertOptions& options)
+{
+    static const gchar* const SCALE_METHODS[SCALE_METHOD_COUNT] = {
+        nullptr, "nearest-neighbour", "nearest-neighbour", "bilinear", "catrom", "lanczos" };
+    static const gchar* const DITHER_METHODS[DITHER_METHOD_COUNT] = {
+        nullptr, "none", "verterr", "floyd-steinberg", "sierra-lite", "bayer" };
+
+    const bool preview = options.scale == SCALE_PREVIEW;
+
+    if (options.threads > 0 && g_object_class_find_property(G_OBJECT_GET_CLASS(element), "n-threads") != nullptr)
+    {
+        g_object_set(element, "n-threads", options.threads, nullptr);
+    }
+
+    // Each is set where the element has it, videoscale's "dither" is a boolean and is left alone
+    setEnumProperty(element, "method", SCALE_METHODS[options.scale]);
+    setEnumProperty(element, "dither", options.dither != DITHER_DEFAULT || !preview ? DITHER_METHODS[options.dither] : "none");
+
+    if (preview)
+    {
+        setEnumProperty(element, "chroma-mode", "none");
+        setEnumProperty(element, "chroma-resampler", "nearest");
+    }
+}
+
+void Internal::setEnumProperty(GstElement* element, const gchar* name, const gchar* value)
+{
+    if (value == nullptr) return;
+
+    GParamSpec* spec = g_object_class_find_property(G_OBJECT_GET_CLASS(element), name);
+    if (spec == nullptr || !G_TYPE_IS_ENUM(spec->value_type)) return;
+
+    gst_util_set_object_arg(G_OBJECT(element), name, value);
+}
+
+void Internal::releaseDecoder(gpointer threads, GObject*)
+{
+    DecoderPolicy::get().release(GPOINTER_TO_UINT(threads));
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Frame queue implementation
+//////////////////////////////////////////////////////////////////////////
+
+FrameQueue::FrameQueue(FrameQueuePolicy policy, guint depth, volatile gint* dropped, PlayerCounters* counters)
+    : mPolicy(policy)
+    , mCapacity(depth + 1)
+    , mDropped(dropped)
+    , mCounters(counters)
+{
+    mSlots = g_new0(Frame*, mCapacity);
+    g_mutex_init(&mLock);
+    g_cond_init(&mCond);
+}
+
+FrameQueue::~FrameQueue()
+{
+    while (Frame* frame = pop())
+    {
+        delete frame;
+    }
+
+    g_free(mSlots);
+    g_mutex_clear(&mLock);
+    g_cond_clear(&mCond);
+}
+
+void FrameQueue::push(Frame* frame)
+{
+    if (mPolicy == FRAME_QUEUE_LATEST)
+    {
+        gpointer previous = nullptr;
+
+        do { previous = g_atomic_pointer_get(&mMailbox); }
+        while (g_atomic_pointer_compare_and_exchange(&mMailbox, previous, frame) == FALSE);
+
+        // UI did not consume the previous frame in time, newer one wins
+        if (previous != nullptr)
+        {
+            drop(static_cast<Frame*>(previous));
+        }
+
+        return;
+    }
+
+    guint head = guint(g_atomic_int_get(&mHead));
+    guint next = (head + 1) % mCapacity;
+
+    if (next == guint(g_atomic_int_get(&mTail)))
+    {
+        if (mPolicy == FRAME_QUEUE_FIFO)
+        {
+            // Queue is full. Simply, skip this frame.
+            drop(frame);
+            return;
+        }
+
+        g_mutex_lock(&mLock);
+        while (next == guint(g_atomic_int_get(&mTail)) && g_atomic_int_get(&mFlushing) == FALSE)
+        {
+            g_cond_wait(&mCond, &mLock);
+        }
+        g_mutex_unlock(&mLock);
+
+        if (next == guint(g_atomic_int_get(&mTail)))
+        {
+            drop(frame);
+            return;
+        }
+    }
+
+    mSlots[head] = frame;
+
+    // Signal UI thread it can consume
+    g_atomic_int_set(&mHead, gint(next));
+}
+
+Frame* FrameQueue::pop()
+{
+    if (mHeld != nullptr)
+    {
+        Frame* frame = mHeld;
+        mHeld = nullptr;
+        return frame;
+    }
+
+    if (mPolicy == FRAME_QUEUE_LATEST)
+    {
+        gpointer frame = nullptr;
+
+        do { frame = g_atomic_pointer_get(&mMailbox); }
+        while (frame != nullptr && g_atomic_pointer_compare_and_exchange(&mMailbox, frame, nullptr) == FALSE);
+
+        return static_cast<Frame*>(frame);
+    }
+
+    guint tail = guint(g_atomic_int_get(&mTail));
+    if (tail == guint(g_atomic_int_get(&mHead)))
+    {
+        return nullptr;
+    }
+
+    Frame* frame = mSlots[tail];
+    mSlots[tail] = nullptr;
+
+    // Signal Streaming thread it can produce
+    g_atomic_int_set(&mTail, gint((tail + 1) % mCapacity));
+
+    if (mPolicy == FRAME_QUEUE_BLOCK)
+    {
+        g_mutex_lock(&mLock);
+        g_cond_signal(&mCond);
+        g_mutex_unlock(&mLock);
+    }
+
+    return frame;
+}
+
+Frame* FrameQueue::popDue(gint64 time)
+{
+    Frame* due = nullptr;
+
+    while (Frame* frame = pop())
+    {
+        const FrameInfo& info = frame->getInfo();
+
+        // Best match for the display time is the latest frame due within half its duration
+        const gint64 slack = GST_CLOCK_TIME_IS_VALID(info.duration) ? gint64(info.duration / (2 * GST_USECOND)) : 0;
+        if (info.presentTime >= 0 && info.presentTime - slack > time)
+        {
+            mHeld = frame;
+            break;
+        }
+
+        // Superseded before it got a chance to be shown
+        if (due != nullptr)
+        {
+            drop(due);
+        }
+
+        due = frame;
+    }
+
+    return due;
+}
+
+void FrameQueue::drop(Frame* frame)
+{
+    delete frame;
+    g_atomic_int_inc(mDropped);
+    mCounters->add(mCounters->dropped[FRAME_DROP_QUEUE]);
+}
+
+void FrameQueue::setFlushing(bool on)
+{
+    g_atomic_int_set(&mFlushing, on ? TRUE : FALSE);
+
+    if (on && mPolicy == FRAME_QUEUE_BLOCK)
+    {
+        g_mutex_lock(&mLock);
+        g_cond_broadcast(&mCond);
+        g_mutex_unlock(&mLock);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Decoder policy implementation
+//////////////////////////////////////////////////////////////////////////
+
+DecoderPolicy& DecoderPolicy::get()
+{
+    static DecoderPolicy policy;
+    return policy;
+}
+
+DecoderPolicy::DecoderPolicy()
+{
+    g_mutex_init(&mLock);
+}
+
+void DecoderPolicy::setBudget(guint threads, guint decoders)
+{
+    g_mutex_lock(&mLock);
+    mThreads    = threads;
+    mDecoders   = MAX(decoders, 1u);
+    g_mutex_unlock(&mLock);
+}
+
+guint DecoderPolicy::acquire()
+{
+    g_mutex_lock(&mLock);
+
+    guint threads = 0;
+    if (mThreads > 0)
     {
-        g_free(discoverer.mMediaUri);
-        discoverer.mMediaUri = nullptr;
+        // First (threads % decoders) slots take the remainder, e.g. 16 over 10 gives 2,2,...,1,1
+        const guint slot = mLive++ % mDecoders;
+        const guint share = mThreads / mDecoders + (slot < mThreads % mDecoders ? 1u : 0u);
+
+        // More decoders than expected only get what is left, but never starve
+        threads = MAX(MIN(share, mThreads - MIN(mUsed, mThreads)), 1u);
+        mUsed += threads;
     }
 
-    discoverer.mWidth     = 0;
-    discoverer.mHeight    = 0;
-    discoverer.mFrameRate = 0;
-    discoverer.mHasAudio  = false;
-    discoverer.mHasVideo  = false;
-    discoverer.mSeekable  = false;
-    discoverer.mDuration  = 0;
+    g_mutex_unlock(&mLock);
+    return threads;
 }
 
-bool Internal::gstreamerInitialized()
+void DecoderPolicy::release(guint threads)
 {
-    GError *init_error = nullptr;
-    BIND_TO_SCOPE(init_error);
+    g_mutex_lock(&mLock);
+    if (mLive > 0) --mLive;
+    mUsed -= MIN(threads, mUsed);
+    g_mutex_unlock(&mLock);
+}
 
-    if (gst_is_initialized() == FALSE &&
-        gst_init_check(nullptr, nullptr, &init_error) == FALSE) {
-        g_debug("GStreamer failed to initialize: %s.", scoped_init_error.pointer->message);
-        return false;
-    } else {
-        return true;
+//////////////////////////////////////////////////////////////////////////
+// Tracer implementation
+//////////////////////////////////////////////////////////////////////////
+
+volatile gint Tracer::sEnabled = FALSE;
+GPrivate Tracer::sRing = G_PRIVATE_INIT(&Tracer::releaseRing);
+
+Tracer& Tracer::get()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::Tracer()
+{
+    g_mutex_init(&mLock);
+    mRings = g_ptr_array_new();
+}
+
+void Tracer::setEnabled(bool on)
+{
+    g_atomic_int_set(&sEnabled, on ? TRUE : FALSE);
+}
+
+void Tracer::setGstLatency(bool on)
+{
+    g_mutex_lock(&mLock);
+
+    if (on != mGstLatency && Internal::gstreamerInitialized())
+    {
+        mGstLatency = on;
+
+        if (on) gst_debug_add_log_function(&Tracer::onGstLog, nullptr, nullptr);
+        else    gst_debug_remove_log_function(&Tracer::onGstLog);
     }
+
+    g_mutex_unlock(&mLock);
 }
 
-GstFlowReturn Internal::onPreroll(GstElement* appsink, ngw::Player* player)
+Tracer::Ring* Tracer::acquire()
 {
-    GstSample* sample = gst_app_sink_pull_preroll(GST_APP_SINK(appsink));
+    Ring* ring = static_cast<Ring*>(g_private_get(&sRing));
+    if (ring != nullptr) return ring;
 
-    // Here's our chance to get the actual dimension of the media.
-    // The actual dimension might be slightly different from what
-    // is passed into and requested from the pipeline.
-    if (sample != nullptr)
+    g_mutex_lock(&mLock);
+
+    if (mFreeRings != nullptr)
     {
-        if (GstCaps *caps = gst_sample_get_caps(sample))
+        ring = static_cast<Ring*>(mFreeRings->data);
+        mFreeRings = g_slist_delete_link(mFreeRings, mFreeRings);
+    }
+    else
+    {
+        ring = new Ring();
+        g_ptr_array_add(mRings, ring);
+    }
+
+    // Events of the previous owner are kept, they carry its trace id
+    ring->thread = ++mThreads;
+    g_mutex_unlock(&mLock);
+
+    g_private_set(&sRing, ring);
+    return ring;
+}
+
+void Tracer::releaseRing(gpointer ring)
+{
+    Tracer& tracer = get();
+
+    g_mutex_lock(&tracer.mLock);
+    tracer.mFreeRings = g_slist_prepend(tracer.mFreeRings, ring);
+    g_mutex_unlock(&tracer.mLock);
+}
+
+void Tracer::appendJson(GString* json, const gchar* text)
+{
+    for (const gchar* c = text; *c != '\0'; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+            g_string_append_printf(json, "\\%c", *c);
+        else if (guchar(*c) < 0x20)
+            g_string_append_printf(json, "\\u%04x", guint(guchar(*c)));
+        else
+            g_string_append_c(json, *c);
+    }
+}
+
+void Tracer::record(const gchar* name, gchar phase, gint64 start, gint64 duration, gint64 value)
+{
+    Ring* ring = acquire();
+    const guint head = guint(g_atomic_int_get(&ring->head));
+
+    Event& event    = ring->events[head % TRACE_RING_SIZE];
+    event.name      = name;
+    event.phase     = phase;
+    event.start     = start;
+    event.duration  = duration;
+    event.value     = value;
+    event.thread    = ring->thread;
+
+    // Publishes the event, dump() discards slots overwritten while it reads them
+    g_atomic_int_set(&ring->head, gint(head + 1));
+}
+
+bool Tracer::dump(const gchar* path)
+{
+    g_return_val_if_fail(!Internal::isNullOrEmpty(path), false);
+
+    GString* json = g_string_new("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    g_string_append(json, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"ngw\"}}");
+
+    Event* events = g_new(Event, TRACE_RING_SIZE);
+    g_mutex_lock(&mLock);
+
+    for (guint index = 0; index < mRings->len; ++index)
+    {
+        Ring* ring = static_cast<Ring*>(g_ptr_array_index(mRings, index));
+
+        const guint head    = guint(g_atomic_int_get(&ring->head));
+        const guint floor   = guint(g_atomic_int_get(&ring->floor));
+        const guint first = head - MIN(head - floor, guint(TRACE_RING_SIZE));
+
+        for (guint seq = first; seq != head; ++seq)
+            events[seq - first] = ring->events[seq % TRACE_RING_SIZE];
+
+        // Slots the owner wrapped around onto while they were copied might be torn
+        const guint written = guint(g_atomic_int_get(&ring->head));
+        const guint skip = written - first >= TRACE_RING_SIZE ? MIN(written - first - TRACE_RING_SIZE + 1, head - first) : 0;
+
+        for (guint seq = first + skip; seq != head; ++seq)
         {
-            if (gst_caps_is_fixed(caps) != FALSE)
-            {
-                if (const GstStructure *str = gst_caps_get_structure(caps, 0))
-                {
-                    if (gst_structure_get_int(str, "width", &player->mWidth) == FALSE ||
-                        gst_structure_get_int(str, "height", &player->mHeight) == FALSE)
-                    {
-                        player->onError("No width/height information available.");
-                    }
-                }
-            }
+            const Event& event = events[seq - first];
+            g_string_append(json, ",\n{\"name\":\"");
+            appendJson(json, event.name);
+            g_string_append_printf(json, "\",\"cat\":\"ngw\",\"ph\":\"%c\",\"ts\":%" G_GINT64_FORMAT ",\"pid\":1,\"tid\":%u",
+                event.phase, event.start, event.thread);
+
+            if (event.phase == 'X')
+                g_string_append_printf(json, ",\"dur\":%" G_GINT64_FORMAT, event.duration);
+            else if (event.phase == 'C')
+                g_string_append_printf(json, ",\"args\":{\"ms\":%.3f}", event.value / gdouble(GST_MSECOND));
             else
-            {
-                player->onError("caps is not fixed for this media.");
-            }
+                g_string_append(json, ",\"s\":\"t\"");
+
+            g_string_append_c(json, '}');
         }
     }
 
-    processSample(player, sample);
-    return GST_FLOW_OK;
+    g_mutex_unlock(&mLock);
+    g_free(events);
+
+    g_string_append(json, "\n]}\n");
+    const bool success = g_file_set_contents(path, json->str, gssize(json->len), nullptr) != FALSE;
+    g_string_free(json, TRUE);
+
+    if (!success) g_debug("Unable to write trace to %s.", path);
+    return success;
 }
 
-GstFlowReturn Internal::onSampled(GstElement* appsink, ngw::Player* player)
+void Tracer::clear()
 {
-    processSample(player, gst_app_sink_pull_sample(GST_APP_SINK(appsink)));
-    return GST_FLOW_OK;
+    g_mutex_lock(&mLock);
+
+    for (guint index = 0; index < mRings->len; ++index)
+    {
+        Ring* ring = static_cast<Ring*>(g_ptr_array_index(mRings, index));
+        g_atomic_int_set(&ring->floor, g_atomic_int_get(&ring->head));
+    }
+
+    g_mutex_unlock(&mLock);
 }
 
-void Internal::processSample(ngw::Player *const player, GstSample* const sample)
+void Tracer::onGstLog(GstDebugCategory* category, GstDebugLevel, const gchar*, const gchar*,
+                      gint, GObject*, GstDebugMessage* message, gpointer)
 {
-    // Check if UI thread has consumed the last frame
-    if (g_atomic_int_get(&player->mBufferDirty) != FALSE) {
-        // Simply, skip this sample. UI is not consuming fast enough.
-        gst_sample_unref(sample);
+    if (!isEnabled() || g_strcmp0(gst_debug_category_get_name(category), "GST_TRACER") != 0)
         return;
+
+    GstStructure* record = gst_structure_from_string(gst_debug_message_get(message), nullptr);
+    if (record == nullptr) return;
+
+    // Latency tracer records: "element-latency" per element, "latency" from a source to a sink
+    guint64 time = 0;
+    const gchar* element = nullptr;
+
+    if (gst_structure_has_name(record, "element-latency"))
+    {
+        element = gst_structure_get_string(record, "element");
+    }
+    else if (gst_structure_has_name(record, "latency"))
+    {
+        element = gst_structure_get_string(record, "sink-element");
     }
 
-    // Acquire and hold onto the new frame (until UI consumes it)
-    player->mCurrentSample = sample;
-    player->mCurrentBuffer = gst_sample_get_buffer(sample);
-    gst_buffer_map(player->mCurrentBuffer, &player->mCurrentMapInfo, GST_MAP_READ);
+    if (element != nullptr && gst_structure_get_uint64(record, "time", &time) != FALSE)
+    {
+        // Interned, so the ring can keep a pointer to it. Element names are few
+        gchar* name = g_strdup_printf("%s:%s", gst_structure_get_name(record), element);
+        get().record(g_intern_string(name), 'C', g_get_monotonic_time(), 0, gint64(time));
+        g_free(name);
+    }
 
-    // Signal UI thread it can consume
-    g_atomic_int_set(&player->mBufferDirty, TRUE);
+    gst_structure_free(record);
 }
 
-void Internal::processDuration(Player& player)
+//////////////////////////////////////////////////////////////////////////
+// Discovery cache implementation
+//////////////////////////////////////////////////////////////////////////
+
+DiscoveryCache& DiscoveryCache::get()
 {
-    g_return_if_fail(player.mPipeline != nullptr);
+    static DiscoveryCache cache;
+    return cache;
+}
 
-    // Nanoseconds
-    gint64 duration_ns = 0;
-    if (gst_element_query_duration(GST_ELEMENT(player.mPipeline), GST_FORMAT_TIME, &duration_ns) != FALSE) {
-        // Seconds
-        player.mDuration = duration_ns / gdouble(GST_SECOND);
+DiscoveryCache::DiscoveryCache()
+{
+    g_mutex_init(&mLock);
+    g_mutex_init(&mSaveLock);
+    mEntries = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, &DiscoveryCache::freeEntry);
+}
+
+void DiscoveryCache::freeEntry(gpointer entry)
+{
+    delete static_cast<Entry*>(entry);
+}
+
+bool DiscoveryCache::stat(const gchar* uri, gint64& size, gint64& mtime)
+{
+    // Only local files can be validated, This is NULL for network URIs
+    gchar* filename = g_filename_from_uri(uri, nullptr, nullptr);
+    BIND_TO_SCOPE(filename);
+
+    GStatBuf info;
+    if (Internal::isNullOrEmpty(filename) || g_stat(scoped_filename.pointer, &info) != 0)
+    {
+        return false;
+    }
+
+    size  = gint64(info.st_size);
+    mtime = gint64(info.st_mtime) * G_USEC_PER_SEC;
+
+    // st_mtime only has seconds, add the sub-second part where the platform reports it
+#if defined(__APPLE__)
+    mtime += gint64(info.st_mtimespec.tv_nsec / 1000);
+#elif defined(G_OS_UNIX)
+    mtime += gint64(info.st_mtim.tv_nsec / 1000);
+#endif
+    return true;
+}
+
+bool DiscoveryCache::lookup(const gchar* uri, Discoverer& discoverer)
+{
+    gint64 size = 0, mtime = 0;
+    if (!stat(uri, size, mtime)) return false;
+
+    bool found = false;
+    g_mutex_lock(&mLock);
+
+    if (mEnabled)
+    {
+        Entry* entry = static_cast<Entry*>(g_hash_table_lookup(mEntries, uri));
+        if (entry != nullptr && entry->size == size && entry->mtime == mtime)
+        {
+            Internal::copy(discoverer, entry->discoverer);
+            found = true;
+        }
+    }
+
+    g_mutex_unlock(&mLock);
+    return found;
+}
+
+void DiscoveryCache::store(const Discoverer& discoverer, bool persist)
+{
+    Entry* entry = new Entry();
+    if (!stat(discoverer.getUri(), entry->size, entry->mtime))
+    {
+        delete entry;
+        return;
+    }
+
+    Internal::copy(entry->discoverer, discoverer);
+    g_mutex_lock(&mLock);
+
+    const bool enabled = mEnabled;
+    if (enabled)
+    {
+        g_hash_table_insert(mEntries, g_strdup(discoverer.getUri()), entry);
+        mDirty = true;
+    }
+    else
+    {
+        delete entry;
+    }
+
+    g_mutex_unlock(&mLock);
+
+    // Lookups of other players are not held up by the file write
+    if (enabled && persist) save();
+}
+
+void DiscoveryCache::flush()
+{
+    save();
+}
+
+void DiscoveryCache::setEnabled(bool on)
+{
+    g_mutex_lock(&mLock);
+    mEnabled = on;
+    g_mutex_unlock(&mLock);
+}
+
+void DiscoveryCache::setFile(const gchar* path)
+{
+    g_mutex_lock(&mLock);
+
+    g_free(mFile);
+    mFile = Internal::isNullOrEmpty(path) ? nullptr : g_strdup(path);
+    load();
+
+    g_mutex_unlock(&mLock);
+}
+
+void DiscoveryCache::clear()
+{
+    g_mutex_lock(&mLock);
+
+    g_hash_table_remove_all(mEntries);
+    mDirty = true;
+
+    g_mutex_unlock(&mLock);
+    save();
+}
+
+void DiscoveryCache::load()
+{
+    if (mFile == nullptr || g_file_test(mFile, G_FILE_TEST_EXISTS) == FALSE) return;
+
+    GKeyFile* key_file = g_key_file_new();
+    BIND_TO_SCOPE(key_file);
+
+    if (g_key_file_load_from_file(key_file, mFile, G_KEY_FILE_NONE, nullptr) == FALSE)
+    {
+        g_debug("Unable to load discovery cache from %s.", mFile);
+        return;
     }
+
+    gchar** groups = g_key_file_get_groups(key_file, nullptr);
+    for (gchar** uri = groups; uri != nullptr && *uri != nullptr; ++uri)
+    {
+        Entry* entry = new Entry();
+        entry->size  = g_key_file_get_int64(key_file, *uri, "size", nullptr);
+        entry->mtime = g_key_file_get_int64(key_file, *uri, "mtime", nullptr);
+        Internal::load(entry->discoverer, key_file, *uri);
+
+        g_hash_table_insert(mEntries, g_strdup(*uri), entry);
+    }
+
+    g_strfreev(groups);
+}
+
+void DiscoveryCache::save()
+{
+    g_mutex_lock(&mLock);
+
+    if (!mDirty || mFile == nullptr)
+    {
+        mDirty = false;
+        g_mutex_unlock(&mLock);
+        return;
+    }
+
+    mDirty = false;
+    const guint64 generation = ++mGeneration;
+    gchar* path = g_strdup(mFile);
+    BIND_TO_SCOPE(path);
+
+    GKeyFile* key_file = g_key_file_new();
+    BIND_TO_SCOPE(key_file);
+
+    GHashTableIter iter;
+    gpointer key = nullptr, value = nullptr;
+    g_hash_table_iter_init(&iter, mEntries);
+
+    while (g_hash_table_iter_next(&iter, &key, &value) != FALSE)
+    {
+        const gchar* uri = static_cast<const gchar*>(key);
+        const Entry* entry = static_cast<const Entry*>(value);
+
+        g_key_file_set_int64(key_file, uri, "size", entry->size);
+        g_key_file_set_int64(key_file, uri, "mtime", entry->mtime);
+        Internal::save(entry->discoverer, key_file, uri);
+    }
+
+    gsize length = 0;
+    gchar* data = g_key_file_to_data(key_file, &length, nullptr);
+    BIND_TO_SCOPE(data);
+
+    g_mutex_unlock(&mLock);
+
+    // Writers may race, a snapshot older than the one on disk is dropped
+    g_mutex_lock(&mSaveLock);
+
+    if (generation > mSaved)
+    {
+        mSaved = generation;
+        if (g_file_set_contents(scoped_path.pointer, scoped_data.pointer, gssize(length), nullptr) == FALSE)
+        {
+            g_debug("Unable to save discovery cache to %s.", scoped_path.pointer);
+        }
+    }
+
+    g_mutex_unlock(&mSaveLock);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Audio ring implementation
+//////////////////////////////////////////////////////////////////////////
+
+AudioRing::AudioRing(guint ring_bytes, guint frame_bytes)
+    : data(nullptr)
+    , size(ring_bytes)
+    , bpf(frame_bytes)
+    , written(0)
+    , read(0)
+    , flushing(FALSE)
+    , flushed(0)
+{
+    data = static_cast<guint8*>(g_malloc(size));
+}
+
+AudioRing::~AudioRing()
+{
+    g_free(data);
+}
+
+gsize AudioRing::push(const guint8* src, gsize bytes)
+{
+    const guint position = guint(g_atomic_int_get(&written));
+    const guint room = size - (position - guint(g_atomic_int_get(&read)));
+
+    // Whole sample frames only, so the consumer never reads half of one
+    const guint count = guint(MIN(bytes, gsize(room))) / bpf * bpf;
+    const guint offset = position & (size - 1);
+    const guint first = MIN(count, size - offset);
+
+    std::memcpy(data + offset, src, first);
+    std::memcpy(data, src + first, count - first);
+
+    g_atomic_int_set(&written, gint(position + count));
+    return bytes - count;
+}
+
+gsize AudioRing::pull(guint8* dst, gsize bytes)
+{
+    guint position = guint(g_atomic_int_get(&read));
+
+    // Samples pushed after the flush (post-seek) are kept, never moves back over what was read already
+    if (g_atomic_int_compare_and_exchange(&flushing, TRUE, FALSE) != FALSE)
+    {
+        const guint skip = guint(g_atomic_int_get(&flushed));
+        if (gint(skip - position) > 0) position = skip;
+        g_atomic_int_set(&read, gint(position));
+    }
+
+    const guint end = guint(g_atomic_int_get(&written));
+
+    const guint count = guint(MIN(bytes, gsize(end - position))) / bpf * bpf;
+    const guint offset = position & (size - 1);
+    const guint first = MIN(count, size - offset);
+
+    std::memcpy(dst, data + offset, first);
+    std::memcpy(dst + first, data, count - first);
+
+    // Producer may only reuse the bytes once they are copied out
+    g_atomic_int_set(&read, gint(position + count));
+    return count;
+}
+
+gsize AudioRing::available() const
+{
+    guint position = guint(g_atomic_int_get(&read));
+
+    if (g_atomic_int_get(&flushing) != FALSE)
+    {
+        const guint skip = guint(g_atomic_int_get(&flushed));
+        if (gint(skip - position) > 0) position = skip;
+    }
+
+    return guint(g_atomic_int_get(&written)) - position;
+}
+
+void AudioRing::flush()
+{
+    g_atomic_int_set(&flushed, g_atomic_int_get(&written));
+    g_atomic_int_set(&flushing, TRUE);
 }
 
 }
@@ -36,12 +36,291 @@ const gchar* getVersion();
  */
 void addPluginPath(const gchar* path);
 
+/*!
+ * @brief   Overrides rank of an element factory ("avdec_h264" for example)
+ * @note    Auto-plugging (and therefore Player) prefers higher ranks. Use it
+ *          to prefer a faster decoder (GST_RANK_PRIMARY + 1) or to keep a
+ *          slow one from being picked at all (GST_RANK_NONE).
+ * @param   factory name of the element factory
+ * @param   rank new rank of the factory
+ * @return  false if no such factory is registered
+ */
+bool setElementRank(const gchar* factory, guint rank);
+
+/*!
+ * @brief   Caps total threads of video decoders created by all players
+ * @details Threads are split evenly between the given number of decoders
+ *          expected to decode at the same time. A decoder gets its share or
+ *          what is left of the budget, whichever is less, and at least one
+ *          thread. Player::setDecoderThreads(...) overrides its share.
+ *          Applied through the thread count property of decoders that have
+ *          one ("max-threads", "threads" or "n-threads"), as they are created.
+ * @param   threads total threads of all video decoders, 0 lifts the cap
+ * @param   decoders number of video decoders expected at the same time
+ */
+void setDecoderThreadBudget(guint threads, guint decoders);
+
 /*!
  * @brief   Appends path to the end of PATH variable
  * @param   path directory to be appended to PATH
  */
 void addBinaryPath(const gchar* path);
 
+/*!
+ * @brief   Enables or disables the process-wide discovery cache (enabled by default)
+ * @details Discoverer::open(...), and therefore Player::open(...), looks local
+ *          files up in this cache before probing them. Entries are keyed by URI
+ *          and are only reused while file size and modification time match.
+ *          Network URIs are never cached. Cache is MT safe.
+ * @param   on true to enable the cache, false to disable it (entries are kept)
+ */
+void setDiscoveryCacheEnabled(bool on);
+
+/*!
+ * @brief   Persists the discovery cache into a file, so it survives restarts
+ * @note    Entries already stored in the file are loaded. The file is rewritten
+ *          every time a new media is discovered.
+ * @param   path file to persist to. nullptr or "" turns persistence off
+ */
+void setDiscoveryCacheFile(const gchar* path);
+
+/*!
+ * @brief   Removes all entries of the discovery cache (and of its file, if any)
+ */
+void clearDiscoveryCache();
+
+/*!
+ * @brief   Turns the built-in tracer on or off (off by default)
+ * @details While on, ngw records spans of open(...), update(), onFrame(...),
+ *          seeks, bus handling and of the streaming thread handing frames off,
+ *          into a fixed size ring per thread. Oldest events are overwritten.
+ *          While off, instrumented code only pays for one atomic read.
+ * @param   on true to record, false to stop recording (events are kept)
+ */
+void setTraceEnabled(bool on);
+
+/*!
+ * @brief   Answers true if the built-in tracer is recording
+ */
+bool getTraceEnabled();
+
+/*!
+ * @brief   Merges records of GStreamer's latency tracer into the trace, as counters
+ * @note    GStreamer only runs its latency tracer if the environment has
+ *          GST_TRACERS="latency(flags=pipeline+element)" and
+ *          GST_DEBUG="GST_TRACER:7" before GStreamer is initialized.
+ * @param   on true to merge latency records, false to stop
+ */
+void setTraceGstLatency(bool on);
+
+/*!
+ * @brief   Writes recorded events as Chrome trace JSON (chrome://tracing, Perfetto)
+ * @note    MT safe, tracing does not need to be stopped first
+ * @param   path file to write to
+ * @return  false if the file could not be written
+ */
+bool dumpTrace(const gchar* path);
+
+/*!
+ * @brief   Discards all recorded events
+ */
+void clearTrace();
+
+/*!
+ * @enum    FrameQueuePolicy
+ * @brief   Policy of the frame queue sitting between GStreamer's streaming
+ *          thread and Player::update(). Set with Player::setFrameQueue(...)
+ */
+enum FrameQueuePolicy
+{
+    FRAME_QUEUE_LATEST          = 0,    //!< Mailbox. A newer frame replaces an unconsumed one (default)
+    FRAME_QUEUE_FIFO            = 1,    //!< First in first out. New frames are dropped if queue is full
+    FRAME_QUEUE_BLOCK           = 2,    //!< First in first out. Streaming thread waits if queue is full
+    FRAME_QUEUE_POLICY_COUNT    = 3     //!< Number of available policies
+};
+
+/*!
+ * @struct  FrameLayout
+ * @brief   Memory layout of a decoded video frame. Packed formats (BGRA, RGB,
+ *          etc.) have a single plane, planar ones (I420, NV12, etc.) have one
+ *          plane per component group.
+ * @note    Offsets and strides come from the GstVideoMeta of the buffer when
+ *          the decoder attached one (padded planes are handed off without a
+ *          copy) and from the negotiated caps otherwise. Plane pointers are
+ *          only valid as long as the frame they were obtained from.
+ */
+struct FrameLayout
+{
+    enum { MAX_PLANES = 4 };                //!< Maximum number of planes, same as GST_VIDEO_MAX_PLANES
+
+    const gchar*    format  = nullptr;      //!< Video format name ("BGRA", "I420", "NV12", etc.)
+    gint            width   = 0;            //!< Width of the frame in pixels
+    gint            height  = 0;            //!< Height of the frame in pixels
+    guint           planes  = 0;            //!< Number of planes in use
+    guchar*         data[MAX_PLANES]    = {};   //!< Pointer to the first byte of each plane
+    gsize           offset[MAX_PLANES]  = {};   //!< Offset of each plane from the start of the frame data in bytes
+    gint            stride[MAX_PLANES]  = {};   //!< Bytes per row of each plane
+};
+
+/*!
+ * @struct  FrameInfo
+ * @brief   Describes a decoded video frame: its layout, its timing and its
+ *          position in the stream. Filled in as the frame leaves GStreamer's
+ *          streaming thread.
+ * @note    Stream times are in nanoseconds (GST_CLOCK_TIME_NONE if unknown).
+ *          Monotonic times are in microseconds, on the time base of
+ *          g_get_monotonic_time(), so they can be compared against the time
+ *          a frame is actually shown to measure latency or skip stale frames.
+ */
+struct FrameInfo
+{
+    FrameLayout     layout;                             //!< Format, size and plane layout of the frame
+    GstClockTime    pts         = GST_CLOCK_TIME_NONE;  //!< Presentation time stamp of the buffer
+    GstClockTime    duration    = GST_CLOCK_TIME_NONE;  //!< Duration of the buffer
+    GstClockTime    runningTime = GST_CLOCK_TIME_NONE;  //!< pts mapped to the running time of the pipeline
+    gint64          presentTime = -1;                   //!< Monotonic time the frame is due on screen. -1 if unknown (pre-rolled frames)
+    gint64          arrivalTime = -1;                   //!< Monotonic time the frame was handed off by the streaming thread
+    guint64         sequence    = 0;                    //!< Number of the frame since open(...), starting from 1
+};
+
+/*!
+ * @enum    FrameDropReason
+ * @brief   Reasons a video frame does not make it to Player::onFrame(...)
+ */
+enum FrameDropReason
+{
+    FRAME_DROP_QUEUE            = 0,    //!< Replaced or rejected by the frame queue, or skipped by update(vblank)
+    FRAME_DROP_LATE             = 1,    //!< Discarded for being late by QoS of the video sink or decoder
+    FRAME_DROP_MAP              = 2,    //!< Buffer of the frame could not be mapped for reading
+    FRAME_DROP_COPY             = 3,    //!< Frame did not fit the caller's buffer it is copied into, see addDroppedFrame(...)
+    FRAME_DROP_REASON_COUNT     = 4     //!< Number of drop reasons
+};
+
+/*!
+ * @struct  PlayerStats
+ * @brief   Runtime counters of a player, returned by Player::getStats()
+ * @note    Counters only ever grow over the lifetime of the player, so
+ *          telemetry can diff two readings. Times are in milliseconds.
+ */
+struct PlayerStats
+{
+    guint64         framesReceived      = 0;    //!< Frames handed off by the video sink
+    guint64         framesDelivered     = 0;    //!< Frames passed to onFrame(...)
+    guint64         framesDropped[FRAME_DROP_REASON_COUNT] = {}; //!< Frames dropped, per FrameDropReason
+    gdouble         averageLatency      = 0.;   //!< Average time from hand off by the streaming thread to onFrame(...)
+    gdouble         maxLatency          = 0.;   //!< Longest time from hand off by the streaming thread to onFrame(...)
+    gdouble         averageFrameTime    = 0.;   //!< Average time spent inside onFrame(...) and onFrameInfo(...)
+    gdouble         maxFrameTime        = 0.;   //!< Longest time spent inside onFrame(...) and onFrameInfo(...)
+    guint64         seeks               = 0;    //!< Seeks completed
+    gdouble         averageSeekLatency  = 0.;   //!< Average time from setTime(...) to the seek completing
+    gdouble         maxSeekLatency      = 0.;   //!< Longest time from setTime(...) to the seek completing
+    guint64         busMessages         = 0;    //!< Messages taken off the pipeline's bus
+    guint64         bytesCopied         = 0;    //!< Bytes of frame data copied out of GStreamer's buffers
+};
+
+/*!
+ * @enum    ScaleMethod
+ * @brief   Resampling used when the video is resized by Player::open(...)
+ */
+enum ScaleMethod
+{
+    SCALE_DEFAULT               = 0,    //!< Left to GStreamer (bilinear)
+    SCALE_PREVIEW               = 1,    //!< Fastest. Nearest neighbour, chroma is not resampled and dithering is off by default
+    SCALE_NEAREST               = 2,    //!< Nearest neighbour
+    SCALE_BILINEAR              = 3,    //!< Bilinear
+    SCALE_CUBIC                 = 4,    //!< Catmull-Rom cubic
+    SCALE_LANCZOS               = 5,    //!< Lanczos, sharpest and slowest
+    SCALE_METHOD_COUNT          = 6     //!< Number of available methods
+};
+
+/*!
+ * @enum    DitherMethod
+ * @brief   Dithering used when the video is converted to a format of lower depth
+ */
+enum DitherMethod
+{
+    DITHER_DEFAULT              = 0,    //!< Left to GStreamer (bayer), or none with SCALE_PREVIEW
+    DITHER_NONE                 = 1,    //!< No dithering, fastest
+    DITHER_VERTERR              = 2,    //!< Propagates rounding errors vertically
+    DITHER_FLOYD_STEINBERG      = 3,    //!< Floyd-Steinberg error diffusion
+    DITHER_SIERRA_LITE          = 4,    //!< Sierra Lite error diffusion
+    DITHER_BAYER                = 5,    //!< Ordered bayer matrix
+    DITHER_METHOD_COUNT         = 6     //!< Number of available methods
+};
+
+/*!
+ * @struct  ConvertOptions
+ * @brief   Set up of the converter and scaler play-bin puts in front of the
+ *          video sink when open(...) asks for another size or format.
+ * @note    Both run single threaded by default, threads pays off most when
+ *          high resolution sources are downscaled (4K to a 720p preview).
+ */
+struct ConvertOptions
+{
+    guint           threads             = 0;    //!< Threads of the converter and scaler, 0 keeps GStreamer's default (one)
+    ScaleMethod     scale               = SCALE_DEFAULT;
+    DitherMethod    dither              = DITHER_DEFAULT;
+};
+
+//! @cond
+class FrameQueue;
+struct OpenTask;
+struct BusEvent;
+struct PlayerCounters;
+struct FramePool;
+struct AudioRing;
+//! @endcond
+
+/*!
+ * @class   Frame
+ * @brief   Move-only lease of a decoded video frame. Keeps the underlying
+ *          GstSample referenced and its buffer mapped for reading until
+ *          the lease is released or destroyed.
+ * @note    Unlike data passed to Player::onFrame(...), a Frame outlives
+ *          the callback and can be handed to another thread (a render or
+ *          an upload thread for example). Releasing is MT safe. Obtain a
+ *          lease through Player::leaseFrame() inside Player::onFrame(...)
+ */
+class Frame
+{
+public:
+    Frame();
+    ~Frame();
+    //! Move constructor, takes over the lease of rhs
+    Frame(Frame&& rhs);
+    //! Move assignment, releases the current lease and takes over the lease of rhs
+    Frame&          operator=(Frame&& rhs);
+    //! releases the lease (no op if not holding a frame)
+    void            release();
+    //! answers true if the lease is holding a frame
+    bool            isValid() const;
+    //! answers pointer to the mapped video data (nullptr if not valid)
+    guchar*         getData() const;
+    //! answers size of the mapped video data in bytes (0 if not valid)
+    gsize           getSize() const;
+    //! answers the mapped buffer info
+    const GstMapInfo& getMapInfo() const;
+    //! answers the leased sample, owned by the lease
+    GstSample*      getSample() const;
+    //! answers the leased buffer, owned by the lease
+    GstBuffer*      getBuffer() const;
+    //! fills in plane pointers, strides and offsets of the leased frame. Answers false if not valid
+    bool            getLayout(FrameLayout& layout) const;
+    //! answers layout, timing and sequence number of the leased frame (defaults if not obtained from a Player)
+    const FrameInfo& getInfo() const;
+
+private:
+    //! @cond
+    friend          class Internal;
+    Frame(const Frame&)             = delete;
+    Frame& operator=(const Frame&)  = delete;
+    //! @endcond
+    GstSample       *mSample    = nullptr;  //!< Referenced sample
+    GstBuffer       *mBuffer    = nullptr;  //!< Buffer of mSample, mapped for reading
+    GstMapInfo      mMapInfo;               //!< Mapped Buffer info
+    FrameInfo       mInfo;                  //!< Descriptor filled in by the Player that produced the frame
+};
+
 /*!
  * @class   Player
  * @brief   Media player class. Designed to play audio through system's
@@ -58,7 +337,8 @@ class Player
 public:
     Player();
     virtual         ~Player();
-    //! opens a media file, can resize and reformat the video (if any). Returns true on success
+    //! opens a media file, can resize and reformat the video (if any). 0 width or height is auto detected. Returns true on success
+    //! @note planar formats ("I420", "NV12", etc.) can be passed as fmt, see getFrameLayout(...) for their planes
     bool            open(const gchar *path, gint width, gint height, const gchar* fmt);
     //! opens a media file, can resize the video (if any). Returns true on success
     bool            open(const gchar *path, gint width, gint height);
@@ -66,6 +346,11 @@ public:
     bool            open(const gchar *path, const gchar* fmt);
     //! opens a media file and auto detects its meta data and outputs 32bit BGRA. Returns true on success
     bool            open(const gchar *path);
+    //! opens a media file in the background (0 width or height is auto detected). onOpened(...) reports the result
+    //! @note only the discovery runs in the background, update() builds the pipeline on the calling thread
+    bool            openAsync(const gchar *path, gint width, gint height, const gchar* fmt);
+    //! opens a media file in the background, auto detecting its meta data. onOpened(...) reports the result
+    bool            openAsync(const gchar *path);
     //! closes the current media file and its associated resources (no op if no media)
     void            close();
     //! stops playback (setting time to 0)
@@ -78,6 +363,63 @@ public:
     void            pause();
     //! update loop logic, MUST be called often in your engine's update loop
     void            update();
+    //! update() which presents the frame due by the next vblank (predicted display time, micro seconds on the
+    //! g_get_monotonic_time() time base). Newer frames are held for later calls, superseded ones are skipped
+    void            update(gint64 vblank);
+    //! hands frames off this many seconds ahead of their due time, so update(vblank) can pick among them (0 by default)
+    //! @note only set this if frames are consumed through update(vblank) and the frame queue is FRAME_QUEUE_FIFO
+    void            setFrameLead(gdouble seconds);
+    //! answers how many seconds ahead of their due time frames are handed off
+    gdouble         getFrameLead() const;
+    //! parses bus messages on a thread shared by all players, update() only drains parsed events. Takes effect on next open(...)
+    void            setBusThread(bool on);
+    //! answers true if bus messages are parsed on the shared bus thread
+    bool            getBusThread() const;
+    //! off hands video frames off as fast as they are decoded, ignoring their time stamps (on by default). Takes effect on next open(...)
+    void            setSync(bool on);
+    //! answers true if video frames are handed off on time
+    bool            getSync() const;
+    //! lets decoders hand off padded frames (rows or planes further apart than packed) as-is instead of repacking them,
+    //! off by default. Takes effect on next open(...)
+    //! @note with it on, data passed to onFrame(...) MUST be read through getFrameLayout(...) or copied out with copyFrame(...)
+    void            setPaddedFrames(bool on);
+    //! answers true if decoders may hand off padded frames
+    bool            getPaddedFrames() const;
+    //! decodes frames straight into caller owned memory (pinned arrays, mapped buffers, etc.) instead of GStreamer's. Takes effect on next open(...)
+    //! @note each buffer must hold size bytes (a whole frame of the format open(...) asks for) and stay valid until close(). Besides the
+    //!       frame being delivered and the getFrameQueueDepth() frames queued, up to 5 more are in flight (the one being converted, 3 in
+    //!       play-sink's video queue and the sink's last sample). Use at least getFrameQueueDepth() + 6, fewer stall the decoder
+    //! @note pass nullptr or 0 count to turn it off. Frames that do not fit are delivered from GStreamer's memory as usual
+    void            setFramePool(guchar* const* buffers, guint count, gsize size);
+    //! sets up video conversion and scaling of media opened by this player. Takes effect on next open(...)
+    void            setConvertOptions(const ConvertOptions& options);
+    //! answers video conversion and scaling set up by setConvertOptions(...)
+    const ConvertOptions& getConvertOptions() const;
+    //! crops pixels off each edge of the video before it is converted and scaled to the size open(...) asked for. All 0 turns it off
+    //! @note can be changed at runtime. While a video is open, at least a pixel of its width and height must be left
+    void            setCrop(gint left, gint top, gint right, gint bottom);
+    //! answers pixels cropped off each edge of the video
+    void            getCrop(gint& left, gint& top, gint& right, gint& bottom) const;
+    //! hands audio to readAudio(...) as interleaved PCM of format ("F32LE", "S16LE", etc.), rate and channels, instead of playing it through
+    //! the system's audio output. latency is the depth of the ring in between, in milli seconds. nullptr format restores the system output
+    //! @note takes effect on next open(...). Audio is handed off on the pipeline clock, the ring drops what the engine does not read in time.
+    //!       Decoders hand off 20 to 40 milli seconds at once, latency must hold that plus a period of the engine's audio thread
+    void            setAudioTap(const gchar* format, gint rate, gint channels, guint latency);
+    //! answers true if audio is handed to readAudio(...)
+    bool            getAudioTap() const;
+    //! copies up to size bytes of PCM (whole sample frames) into dst, answers bytes copied. Fewer than asked is an underrun, pad it with silence
+    //! @note lock-free, meant for the engine's audio thread. ONLY one thread may read, and MUST not overlap destruction of the player
+    gsize           readAudio(guchar* dst, gsize size);
+    //! answers bytes of PCM readAudio(...) can copy right now. Same threading rules as readAudio(...)
+    gsize           getAudioAvailable() const;
+    //! answers runtime counters of the player. Cheap enough to call every frame, from the thread calling update()
+    PlayerStats     getStats() const;
+    //! sets a property of decoders created by this player, where they have it. nullptr value unsets it. Takes effect on next open(...)
+    void            setDecoderProperty(const gchar* name, const gchar* value);
+    //! sets threads of video decoders created by this player, 0 follows setDecoderThreadBudget(...). Takes effect on next open(...)
+    void            setDecoderThreads(guint threads);
+    //! answers threads of video decoders created by this player, 0 if it follows setDecoderThreadBudget(...)
+    guint           getDecoderThreads() const;
     //! answers duration of the media file. Valid after call to open()
     gdouble         getDuration() const;
     //! sets state of the player (GST_STATE_PAUSED, etc.)
@@ -92,6 +434,10 @@ public:
     void            setTime(gdouble time);
     //! answers the current position of the player between [ 0. , getDuration() ]
     gdouble         getTime() const;
+    //! while on, setTime(...) seeks to the nearest key frame (fast). Turning off seeks accurately to the last time set
+    void            setScrubbing(bool on);
+    //! answers true if the player is in scrub mode
+    bool            getScrubbing() const;
     //! sets the current volume of the player between [ 0. , 1. ]
     void            setVolume(gdouble vol);
     //! gets the current volume of the player between [ 0. , 1. ]
@@ -108,16 +454,57 @@ public:
     void            setRate(gdouble rate);
     //! gets the current rate of the playback (1. is normal speed forward playback)
     gdouble         getRate() const;
+    //! sets policy and depth (in frames) of the frame queue. Takes effect on the next call to open()
+    void            setFrameQueue(FrameQueuePolicy policy, guint depth);
+    //! answers the frame queue policy used by the player
+    FrameQueuePolicy getFrameQueuePolicy() const;
+    //! answers the frame queue depth used by the player (always 1 for FRAME_QUEUE_LATEST)
+    guint           getFrameQueueDepth() const;
+    //! answers number of frames dropped by the frame queue under the given policy since open()
+    guint           getDroppedFrames(FrameQueuePolicy policy) const;
+    //! keeps the play-bin alive across close() / open(...), swapping only its URI and caps (off by default)
+    void            setReusePipeline(bool on);
+    //! answers true if the play-bin is kept alive across close() / open(...)
+    bool            getReusePipeline() const;
+    //! queues a media to be played gap-less after the current one. Valid after open(...), cleared by close()
+    bool            enqueue(const gchar *path);
+    //! removes all media queued by enqueue(...)
+    void            clearQueue();
+    //! answers number of media queued by enqueue(...) and not started yet
+    guint           getQueueLength() const;
+    //! answers URI of the media being played. Changes as queued media starts (empty if nothing is open)
+    const gchar*    getUri() const;
 
 protected:
     //! Video frame callback, video buffer data and its size are passed in
     virtual void    onFrame(guchar* buf, gsize size) const {};
+    //! Video frame callback with its descriptor (layout, time stamps, sequence). Called right after onFrame(...)
+    virtual void    onFrameInfo(const FrameInfo& info, guchar* buf, gsize size) const {};
     //! Error callback, will be called if player encounters any errors. With a string message
     virtual void    onError(const gchar* msg) const {};
     //! State change event, propagated by the pipeline. Old state passed in, obtain new state with getState()
     virtual void    onState(GstState) const {};
     //! Called on end of the stream. Playback is finished at this point
     virtual void    onStreamEnd() const {};
+    //! Called when a queued media (or the looped one) starts playing. Its URI is passed in
+    virtual void    onTrackChanged(const gchar* uri) const {};
+    //! Called from update() once a media opened with openAsync(...) is pre-rolled (true) or failed (false)
+    virtual void    onOpened(bool success) const {};
+    //! Called when a seek is completed. Seconds passed since the seek was issued are passed in
+    virtual void    onSeeked(gdouble latency) const {};
+    //! leases the current frame so it stays valid beyond onFrame(...). ONLY valid inside onFrame(...)
+    Frame           leaseFrame() const;
+    //! answers index of the setFramePool(...) buffer holding the frame, -1 if it is in GStreamer's memory. ONLY valid inside onFrame(...)
+    gint            getFramePoolIndex() const;
+    //! adds to PlayerStats::bytesCopied. For subclasses which copy frame data (into a texture, etc.)
+    void            addCopiedBytes(guint64 bytes) const;
+    //! adds to PlayerStats::framesDropped. For subclasses which give up on a frame they were handed (too big to copy, etc.)
+    void            addDroppedFrame(FrameDropReason reason) const;
+    //! fills in plane pointers, strides and offsets of the buffer passed to onFrame(...). ONLY valid inside onFrame(...)
+    bool            getFrameLayout(FrameLayout& layout) const;
+    //! copies the frame passed to onFrame(...) into dst packed (default strides of its format), removing any padding. Answers
+    //! bytes copied, 0 if size can not hold the packed frame. ONLY valid inside onFrame(...)
+    gsize           copyFrame(guchar* dst, gsize size) const;
 
     //! @cond
     //! These APIs are present in case user of ngw needs to hold on to a frame beyond scope of the onFrame(...)
@@ -133,24 +520,62 @@ private:
     friend          class Internal;
     //! @endcond
     GstState        mState;                 //!< Current state of the player (playing, paused, etc.)
-    GstMapInfo      mCurrentMapInfo;        //!< Mapped Buffer info, ONLY valid inside onFrame(...)
-    GstSample       *mCurrentSample;        //!< Mapped Sample, ONLY valid inside onFrame(...)
-    GstBuffer       *mCurrentBuffer;        //!< Mapped Buffer, ONLY valid inside onFrame(...)
+    Frame           *mCurrentFrame;         //!< Mapped Frame, ONLY valid inside onFrame(...)
     GstElement      *mPipeline;             //!< GStreamer pipeline (play-bin) object
     GstBus          *mGstBus;               //!< Bus associated with mPipeline
+    GSource         *mBusWatch;             //!< Watch of mGstBus on the shared bus thread, nullptr if update() polls the bus
+    gpointer        mBusEvents;             //!< Atomic list of BusEvent (newest first), pushed by the bus thread, drained by update()
+    mutable GMutex  mBusLock;               //!< Serializes the bus thread's callback against removal of mBusWatch
+    GHashTable      *mDecoderProps;         //!< Properties set by setDecoderProperty(...), name => value
+    GHashTable      *mDecoderSetup;         //!< Copy of mDecoderProps taken by open(...), read by the streaming threads
+    FrameQueue      *mFrameQueue;           //!< Frames handed from the streaming thread to update()
+    PlayerCounters  *mCounters;             //!< Counters behind getStats(), live as long as the player
+    GstBufferPool   *mBufferPool;           //!< Pool over mPoolBuffers offered to upstream by the video sink, nullptr if none
+    guchar          **mPoolBuffers = nullptr; //!< Buffers set by setFramePool(...)
+    OpenTask        *mOpenTask;             //!< Discovery of a pending openAsync(...), nullptr if none
+    gchar           *mTrackUri;             //!< URI of the media being played
+    gchar           *mNextTrackUri;         //!< URI handed to play-bin ahead of time, not started yet
+    GQueue          mPlaylist;              //!< URIs queued by enqueue(...)
+    mutable GMutex  mPlaylistLock;          //!< Guards play list members, shared with the streaming thread
 
     mutable gint    mWidth      = 0;        //!< Width of the video being played. Valid after a call to open(...)
     mutable gint    mHeight     = 0;        //!< Height of the video being played. Valid after a call to open(...)
+    gint            mSourceWidth  = 0;      //!< Decoded width of the video being played, before crop and scaling
+    gint            mSourceHeight = 0;      //!< Decoded height of the video being played, before crop and scaling
     mutable gdouble mDuration   = 0.;       //!< Duration of the media being played
     mutable gdouble mTime       = 0.;       //!< Current time of the media being played (current position)
     mutable gdouble mVolume     = 1.;       //!< Volume of the media being played
     mutable gdouble mRate       = 1.;       //!< Rate of playback, negative number for reverse playback
+    gdouble         mFrameLead  = 0.;       //!< Seconds frames are handed off ahead of their due time
+    guint           mDecoderThreads = 0;    //!< Threads of video decoders set by setDecoderThreads(...)
+    guint           mSetupThreads = 0;      //!< Copy of mDecoderThreads taken by open(...), read by the streaming threads
+    ConvertOptions  mConvert;               //!< Set by setConvertOptions(...)
+    ConvertOptions  mSetupConvert;          //!< Copy of mConvert taken by open(...), read by the streaming threads
+    gint            mCrop[4] = { 0, 0, 0, 0 }; //!< Pixels cropped off left, top, right and bottom edges by setCrop(...)
+    AudioRing       *mAudioRing = nullptr;  //!< PCM handed from the audio sink to readAudio(...), allocated by setAudioTap(...)
+    GSList          *mRetiredAudioRings = nullptr; //!< Rings replaced by setAudioTap(...), freed with the player as readAudio(...) may still use them
+    gchar           *mAudioCaps = nullptr;  //!< Caps of the audio sink set by setAudioTap(...), nullptr plays through the system
+    guint           mAudioBpf   = 0;        //!< Bytes per sample frame of mAudioCaps
+    guint           mAudioRingSize = 0;     //!< Bytes of mAudioRing holding latency set by setAudioTap(...), a power of two
+    guint64         mFrameCount;            //!< Frames handed off since open(...), ONLY touched by the streaming thread
+    gsize           mPoolSize   = 0;        //!< Bytes of each of mPoolBuffers
+    guint           mPoolCount  = 0;        //!< Number of mPoolBuffers
 
-    volatile gint   mBufferDirty;           //!< Atomic boolean, representing a new frame is ready by GStreamer
-    mutable gdouble mPendingSeek;           //!< Value of the seek operation pending to be executed
+    volatile gint   mDroppedFrames[FRAME_QUEUE_POLICY_COUNT]; //!< Atomic counters, frames dropped per policy
+    FrameQueuePolicy mQueuePolicy = FRAME_QUEUE_LATEST; //!< Policy of the frame queue created by open()
+    guint           mQueueDepth = 1;        //!< Depth of the frame queue created by open()
+    mutable gdouble mPendingSeek;           //!< Value of the seek operation pending to be executed (negative if none)
+    gdouble         mScrubTarget;           //!< Last time set while scrubbing (negative if none)
+    gint64          mSeekStart;             //!< Monotonic time (micro seconds) the seek in flight was issued
     mutable bool    mSeekingLock;           //!< Boolean flag, indicating a seek operation pending to be executed
     bool            mLoop       = false;    //!< Flag, indicating whether the player is looping or not
     bool            mMute       = false;    //!< Flag, indicating whether the player is muted or not
+    bool            mReusePipeline = false; //!< Flag, indicating whether close() keeps mPipeline for the next open(...)
+    bool            mOpening;               //!< Flag, indicating openAsync(...) waits for the pipeline to pre-roll
+    bool            mScrubbing  = false;    //!< Flag, indicating whether seeks snap to key frames or not
+    bool            mBusThread  = false;    //!< Flag, indicating whether bus messages are parsed on the shared bus thread
+    bool            mSync       = true;     //!< Flag, indicating whether the video sink waits for time stamps of frames
+    bool            mPaddedFrames = false;  //!< Flag, indicating whether the video sink advertises video meta upstream
 };
 
 /*!
@@ -208,4 +633,234 @@ private:
     bool            mSeekable   = false;    //!< Indicates whether media is seek able or not
 };
 
+/*!
+ * @class   DiscovererBatch
+ * @brief   Discovers many media files in parallel. Queued media is probed
+ *          by a bounded pool of worker threads, each one driving its own
+ *          GstDiscoverer in async mode. Useful to index a media library.
+ * @note    API of this class is not MT safe. Results are delivered on the
+ *          thread calling update() or wait(). Discovery cache is used and
+ *          filled the same way Discoverer::open(...) does.
+ * @details To obtain results, you need to subclass and override
+ *          onDiscovered(...) method. It is called once per queued media.
+ */
+class DiscovererBatch
+{
+public:
+    //! at most "workers" media are probed at the same time (0 means number of processors)
+    explicit        DiscovererBatch(guint workers = 0);
+    virtual         ~DiscovererBatch();
+    //! queues a media for discovery. Returns false if path is empty
+    bool            add(const gchar* path);
+    //! delivers finished discoveries through onDiscovered(...). MUST be called often
+    void            update();
+    //! blocks until every queued media is delivered through onDiscovered(...)
+    void            wait();
+    //! drops queued media which is not being probed yet. It will not be delivered
+    void            cancel();
+    //! answers number of queued media not delivered yet
+    guint           getPending() const;
+    //! answers true if every queued media is delivered
+    bool            isDone() const;
+
+protected:
+    //! Discovery callback. success is false if media could not be discovered (getUri() is still valid)
+    virtual void    onDiscovered(const Discoverer& discoverer, bool success) const {};
+
+private:
+    //! @cond
+    friend          class Internal;
+    DiscovererBatch(const DiscovererBatch&)             = delete;
+    DiscovererBatch& operator=(const DiscovererBatch&)  = delete;
+    //! @endcond
+    GAsyncQueue     *mPaths;                //!< Paths waiting to be picked up by a worker
+    GAsyncQueue     *mResults;              //!< Discovered media waiting to be delivered
+    GThread         **mWorkers  = nullptr;  //!< Worker threads, started by the first call to add(...)
+    guint           mWorkerCount;           //!< Number of worker threads
+    volatile gint   mPending    = 0;        //!< Atomic counter, queued media not delivered yet
+};
+
+/*!
+ * @class   PlayerGroup
+ * @brief   Plays a set of players in lock step (video walls for example).
+ *          Members are slaved to one GstClock and started with a common
+ *          base time, so equal running times are presented at the same
+ *          instant on every member.
+ * @note    API of this class is not MT safe. Members are not owned by the
+ *          group and must be removed (or the group destroyed) before they
+ *          are destroyed. Use gap-less Player::setLoop(...) to loop members.
+ * @details Members may be (re)opened while in the group, the group clock is
+ *          applied to their pipelines on every group-wide call.
+ */
+class PlayerGroup
+{
+public:
+    PlayerGroup();
+    ~PlayerGroup();
+    //! adds a player to the group. Returns false if it is already a member
+    bool            add(Player& player);
+    //! removes a player from the group, it goes back to its own clock
+    void            remove(Player& player);
+    //! answers number of players in the group
+    guint           getSize() const;
+    //! starts or resumes playback of all members at the same running time
+    void            play();
+    //! pauses playback of all members
+    void            pause();
+    //! seeks all members to a given time and waits for them to pre-roll. Playback resumes together if it was playing
+    void            setTime(gdouble time);
+    //! answers the position members are expected at, from the shared clock and the last setTime(...)
+    gdouble         getTime() const;
+    //! answers how far a member is ahead (positive) or behind (negative) of the group's expected position, in seconds
+    gdouble         getDrift(const Player& player) const;
+    //! answers the clock shared by all members
+    GstClock*       getClock() const;
+
+private:
+    //! @cond
+    friend          class Internal;
+    PlayerGroup(const PlayerGroup&)             = delete;
+    PlayerGroup& operator=(const PlayerGroup&)  = delete;
+    //! @endcond
+    GstClock        *mClock;                //!< Clock shared by all members
+    GPtrArray       *mPlayers;              //!< Members of the group (Player*), not owned
+    GstClockTime    mBaseTime   = 0;        //!< Base time shared by all members while playing
+    GstClockTime    mRunningTime = 0;       //!< Running time of the group at the last pause or seek
+    gdouble         mPosition   = 0.;       //!< Media position running time counts from, set by setTime(...)
+    bool            mPlaying    = false;    //!< Flag, indicating whether the group is playing or not
+};
+
+/*!
+ * @struct  PlayerState
+ * @brief   Snapshot of a player, filled in by PlayerManager::update(...)
+ */
+struct PlayerState
+{
+    const Player*   player      = nullptr;  //!< Player this snapshot belongs to
+    GstState        state       = GST_STATE_NULL; //!< Current state of the player
+    gdouble         time        = 0.;       //!< Current position in seconds
+    gdouble         duration    = 0.;       //!< Duration of the media in seconds
+    gint            width       = 0;        //!< Width of the video, 0 if audio only
+    gint            height      = 0;        //!< Height of the video, 0 if audio only
+    guint64         sequence    = 0;        //!< Sequence number of the frame delivered by this update, 0 if none
+};
+
+/*!
+ * @class   PlayerManager
+ * @brief   Updates many players in one call (a scene full of video surfaces
+ *          for example) and reports a snapshot of each of them, so engines
+ *          and bindings do not need a call per player and per property.
+ * @note    API of this class is not MT safe. Players are not owned by the
+ *          manager and must be removed (or the manager destroyed) before
+ *          they are destroyed.
+ * @details Players are updated and their callbacks are called on the thread
+ *          calling update(...). Frames they deliver are then handed to
+ *          onProcess(...) on a worker pool (if any) and update(...) returns
+ *          once all of them are processed.
+ */
+class PlayerManager
+{
+public:
+    //! 0 workers calls onProcess(...) on the thread calling update(...)
+    PlayerManager(guint workers = 0);
+    virtual         ~PlayerManager();
+    //! adds a player to the manager. Returns false if it is already managed
+    bool            add(Player& player);
+    //! removes a player from the manager
+    void            remove(Player& player);
+    //! answers number of managed players
+    guint           getSize() const;
+    //! answers a managed player by its index, in order of addition (nullptr if out of range)
+    Player*         getPlayer(guint index) const;
+    //! updates all players. Fills up to count snapshots (in order of addition) and answers number of them filled
+    //! @note callbacks may add(...) or remove(...) players. Players added are updated from the next call, a removed one is skipped
+    //!       and its snapshot is left empty (nullptr player)
+    guint           update(PlayerState* states, guint count);
+    //! same as update(states, count), presenting frames due by the next vblank. See Player::update(vblank)
+    guint           update(PlayerState* states, guint count, gint64 vblank);
+
+protected:
+    //! Called for every frame delivered by update(...), on a worker thread. Frame is released afterwards
+    virtual void    onProcess(const Player& player, Frame& frame) const {};
+
+private:
+    //! @cond
+    friend          class Internal;
+    PlayerManager(const PlayerManager&)             = delete;
+    PlayerManager& operator=(const PlayerManager&)  = delete;
+    //! @endcond
+    GPtrArray       *mPlayers;              //!< Managed players (Player*), not owned
+    GPtrArray       *mUpdating;             //!< Copy of mPlayers walked by update(...), remove(...) clears its entry. Reused across updates
+    GThreadPool     *mWorkers   = nullptr;  //!< Runs onProcess(...), nullptr if there are no workers
+    volatile gint   mPending    = 0;        //!< Atomic counter, frames of the current update(...) not processed yet
+    GMutex          mLock;                  //!< Guards waiting for mPending to drop to 0
+    GCond           mCond;                  //!< Signaled when mPending drops to 0
+};
+
+/*!
+ * @class   Thumbnailer
+ * @brief   Extracts video frames of a media at given times, for thumbnails
+ *          or timeline preview strips. Frames are decoded in parallel by a
+ *          bounded number of headless (video only, no clock) pipelines.
+ * @note    API of this class is not MT safe. Frames are delivered on the
+ *          thread calling update() or wait(), in the order they are ready.
+ * @details To obtain frames, you need to subclass and override the
+ *          onThumbnail(...) method. Frames are in any format Player supports.
+ */
+class Thumbnailer
+{
+public:
+    //! at most "pipelines" frames are decoded at the same time (0 means number of processors)
+    explicit        Thumbnailer(guint pipelines = 0);
+    virtual         ~Thumbnailer();
+    //! opens a media. 0 width or height is derived from the video keeping its aspect ratio. Returns true on success
+    bool            open(const gchar *path, gint width, gint height, const gchar* fmt);
+    //! opens a media, thumbnails are 32bit BGRA of the given size. Returns true on success
+    bool            open(const gchar *path, gint width, gint height);
+    //! drops pending requests and closes the media (no op if no media)
+    void            close();
+    //! requests the frame at time (seconds), clamped to the last frame of the media. Valid after open(...)
+    bool            extract(gdouble time);
+    //! requests count frames evenly spaced over the media. Valid after open(...)
+    bool            extractStrip(guint count);
+    //! delivers extracted frames through onThumbnail(...). MUST be called often
+    void            update();
+    //! blocks until every requested frame is delivered through onThumbnail(...) or onError(...)
+    void            wait();
+    //! drops requests which are not being decoded yet. They will not be delivered
+    void            cancel();
+    //! answers number of requested frames not delivered yet
+    guint           getPending() const;
+    //! answers true if every requested frame is delivered
+    bool            isDone() const;
+    //! answers width of the thumbnails. Valid after open(...)
+    gint            getWidth() const;
+    //! answers height of the thumbnails. Valid after open(...)
+    gint            getHeight() const;
+    //! answers meta data of the opened media. Valid after open(...)
+    const Discoverer& getDiscoverer() const;
+
+protected:
+    //! Thumbnail callback. Requested time and its frame are passed in. Move the frame out to keep it
+    virtual void    onThumbnail(gdouble time, Frame& frame) const {};
+    //! Error callback, will be called if a frame could not be extracted. With a string message
+    virtual void    onError(const gchar* msg) const {};
+
+private:
+    //! @cond
+    friend          class Internal;
+    Thumbnailer(const Thumbnailer&)             = delete;
+    Thumbnailer& operator=(const Thumbnailer&)  = delete;
+    //! @endcond
+    Discoverer      mDiscoverer;            //!< Meta data of the opened media
+    gchar           *mCaps      = nullptr;  //!< Caps of the thumbnails, nullptr if nothing is open
+    GAsyncQueue     *mRequests;             //!< Requested times waiting to be picked up by a pipeline
+    GAsyncQueue     *mResults;              //!< Extracted frames waiting to be delivered
+    GThread         **mWorkers  = nullptr;  //!< Pipeline threads, started by the first request after open(...)
+    guint           mWorkerCount;           //!< Number of pipeline threads
+    gint            mWidth      = 0;        //!< Width of the thumbnails
+    gint            mHeight     = 0;        //!< Height of the thumbnails
+    volatile gint   mPending    = 0;        //!< Atomic counter, requested frames not delivered yet
+};
+
 } // !namespace ngw
@@ -0,0 +1,342 @@
+#include "ngw.hpp"
+
+#include <glib/gstdio.h>
+#include <ctime>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Headless decode throughput benchmark. Generates its own media with
+// videotestsrc, plays each one back as fast as possible and prints JSON.
+namespace {
+
+struct Codec
+{
+    const gchar*    name;
+    const gchar*    encoder;    //!< Encoder element, checked for availability
+    const gchar*    chain;      //!< Encoder and parser part of the generating pipeline
+    const gchar*    muxer;
+    const gchar*    extension;
+};
+
+const Codec CODECS[] = {
+    { "h264",   "x264enc",  "x264enc speed-preset=ultrafast key-int-max=30 ! h264parse",    "mp4mux",       "mp4"  },
+    { "h265",   "x265enc",  "x265enc speed-preset=ultrafast key-int-max=30 ! h265parse",    "matroskamux",  "mkv"  },
+    { "vp8",    "vp8enc",   "vp8enc deadline=1 keyframe-max-dist=30",                       "webmmux",      "webm" },
+    { "vp9",    "vp9enc",   "vp9enc deadline=1 keyframe-max-dist=30",                       "webmmux",      "webm" },
+    { "mjpeg",  "jpegenc",  "jpegenc",                                                      "avimux",       "avi"  },
+};
+
+struct Resolution
+{
+    gint            width;
+    gint            height;
+};
+
+const Resolution RESOLUTIONS[] = {
+    {  640,  360 },
+    { 1280,  720 },
+    { 1920, 1080 },
+};
+
+const guint     FRAME_QUEUE_DEPTH   = 8;
+const gint64    TIMEOUT             = 120 * G_USEC_PER_SEC;
+
+struct Result
+{
+    const Codec*    codec       = nullptr;
+    Resolution      resolution  = { 0, 0 };
+    guint           expected    = 0;        //!< Frames encoded into the media
+    guint           frames      = 0;        //!< Frames delivered through onFrame(...)
+    guint           dropped     = 0;
+    gdouble         seconds     = 0.;       //!< Wall time from play() to the last frame
+    gdouble         cpu         = 0.;       //!< Process CPU seconds from play() to the last frame
+    gdouble         ttff        = -1.;      //!< Milli seconds from open(...) to the first frame
+    std::string     error;
+};
+
+class BenchPlayer : public ngw::Player
+{
+public:
+    mutable guint       mFrames     = 0;
+    mutable gint64      mFirstFrame = -1;
+    mutable bool        mDone       = false;
+    mutable std::string mError;
+
+    virtual void onFrame(guchar*, gsize) const override
+    {
+        if (mFrames++ == 0) mFirstFrame = g_get_monotonic_time();
+    }
+
+    virtual void onError(const gchar* msg) const override
+    {
+        mError  = msg != nullptr ? msg : "unknown error";
+        mDone   = true;
+    }
+
+    virtual void onStreamEnd() const override
+    {
+        mDone = true;
+    }
+};
+
+bool generate(const Codec& codec, const Resolution& res, guint frames, const gchar* path)
+{
+    if (g_file_test(path, G_FILE_TEST_EXISTS)) return true;
+
+    gchar* cmd = g_strdup_printf(
+        "videotestsrc num-buffers=%u pattern=smpte horizontal-speed=4 ! "
+        "video/x-raw,width=%d,height=%d,framerate=30/1 ! videoconvert ! "
+        "%s ! %s ! filesink location=\"%s\"",
+        frames, res.width, res.height, codec.chain, codec.muxer, path);
+
+    GstElement* pipeline = gst_parse_launch(cmd, nullptr);
+    g_free(cmd);
+
+    if (pipeline == nullptr) return false;
+
+    gst_element_set_state(pipeline, GST_STATE_PLAYING);
+
+    GstBus* bus = gst_element_get_bus(pipeline);
+    GstMessage* msg = gst_bus_timed_pop_filtered(bus, GST_CLOCK_TIME_NONE,
+        GstMessageType(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+
+    const bool success = msg != nullptr && GST_MESSAGE_TYPE(msg) == GST_MESSAGE_EOS;
+
+    if (msg != nullptr) gst_message_unref(msg);
+    gst_object_unref(bus);
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(pipeline);
+
+    // Half written media would be picked up by the next run
+    if (!success) g_remove(path);
+    return success;
+}
+
+Result run(const Codec& codec, const Resolution& res, guint frames, const gchar* path)
+{
+    Result result;
+    result.codec        = &codec;
+    result.resolution   = res;
+    result.expected     = frames;
+
+    BenchPlayer player;
+    player.setSync(false);
+    player.setFrameQueue(ngw::FRAME_QUEUE_BLOCK, FRAME_QUEUE_DEPTH);
+
+    const gint64 open_time = g_get_monotonic_time();
+
+    if (!player.open(path))
+    {
+        result.error = player.mError.empty() ? "unable to open media" : player.mError;
+        return result;
+    }
+
+    const gint64 start_time = g_get_monotonic_time();
+    const std::clock_t start_cpu = std::clock();
+    player.play();
+
+    // Each update() presents at most one frame, keep going until the queue drains after EOS
+    for (guint last = 0; g_get_monotonic_time() - start_time < TIMEOUT; last = player.mFrames)
+    {
+        player.update();
+
+        if (player.mFrames == last)
+        {
+            if (player.mDone) break;
+            g_usleep(100);
+        }
+    }
+
+    const gint64 end_time = g_get_monotonic_time();
+    const std::clock_t end_cpu = std::clock();
+
+    result.frames   = player.mFrames;
+    result.seconds  = gdouble(end_time - start_time) / G_USEC_PER_SEC;
+    result.cpu      = gdouble(end_cpu - start_cpu) / CLOCKS_PER_SEC;
+    result.ttff     = player.mFirstFrame >= 0 ? gdouble(player.mFirstFrame - open_time) / 1000. : -1.;
+    result.error    = player.mError;
+
+    const ngw::PlayerStats stats = player.getStats();
+    for (gint reason = 0; reason < ngw::FRAME_DROP_REASON_COUNT; ++reason)
+    {
+        result.dropped += guint(stats.framesDropped[reason]);
+    }
+
+    // Frames lost without a trace (decoder errors) count as dropped too
+    if (result.frames + result.dropped < result.expected)
+    {
+        result.dropped = result.expected - result.frames;
+    }
+
+    player.close();
+    return result;
+}
+
+// g_strescape emits octal escapes, which JSON does not have. UTF-8 passes through
+std::string escapeJson(const std::string& text)
+{
+    std::string escaped;
+    escaped.reserve(text.size());
+
+    for (const char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            char code[8];
+            snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(static_cast<unsigned char>(c)));
+            escaped += code;
+        }
+        else
+        {
+            escaped += c;
+        }
+    }
+
+    return escaped;
+}
+
+void print(FILE* out, const std::vector<Result>& results)
+{
+    fprintf(out, "{\n  \"version\": \"%s\",\n  \"results\": [", ngw::getVersion());
+
+    for (size_t index = 0; index < results.size(); ++index)
+    {
+        const Result& r = results[index];
+        const std::string error = escapeJson(r.error);
+
+        fprintf(out, "%s\n    { \"codec\": \"%s\", \"width\": %d, \"height\": %d, "
+            "\"frames\": %u, \"expected\": %u, \"dropped\": %u, \"seconds\": %.3f, "
+            "\"fps\": %.2f, \"cpu_ms_per_frame\": %.3f, \"ttff_ms\": %.2f, \"error\": \"%s\" }",
+            index > 0 ? "," : "",
+            r.codec->name, r.resolution.width, r.resolution.height,
+            r.frames, r.expected, r.dropped, r.seconds,
+            r.seconds > 0. ? r.frames / r.seconds : 0.,
+            r.frames > 0 ? r.cpu * 1000. / r.frames : 0.,
+            r.ttff, error.c_str());
+    }
+
+    fprintf(out, "\n  ]\n}\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    gint    frames      = 300;
+    gchar*  media_dir   = nullptr;
+    gchar*  output      = nullptr;
+    gchar*  codecs      = nullptr;
+    gchar*  trace       = nullptr;
+
+    GOptionEntry entries[] = {
+        { "frames", 'n', 0, G_OPTION_ARG_INT,      &frames,    "Frames encoded into each test media (300)", "N" },
+        { "media",  'm', 0, G_OPTION_ARG_FILENAME, &media_dir, "Directory test media is generated into and reused from (temp)", "DIR" },
+        { "output", 'o', 0, G_OPTION_ARG_FILENAME, &output,    "Writes JSON into FILE instead of standard output", "FILE" },
+        { "codecs", 'c', 0, G_OPTION_ARG_STRING,   &codecs,    "Comma separated codecs to run (h264,h265,vp8,vp9,mjpeg)", "LIST" },
+        { "trace",  't', 0, G_OPTION_ARG_FILENAME, &trace,     "Records playback and writes it into FILE as Chrome trace JSON", "FILE" },
+        { nullptr }
+    };
+
+    GOptionContext* context = g_option_context_new("- ngw decode throughput benchmark");
+    g_option_context_add_main_entries(context, entries, nullptr);
+    g_option_context_add_group(context, gst_init_get_option_group());
+
+    GError* error = nullptr;
+    if (!g_option_context_parse(context, &argc, &argv, &error))
+    {
+        fprintf(stderr, "%s\n", error->message);
+        g_error_free(error);
+        g_option_context_free(context);
+        return 1;
+    }
+
+    g_option_context_free(context);
+
+    if (frames <= 0)
+    {
+        fprintf(stderr, "Number of frames must be positive.\n");
+        return 1;
+    }
+
+    // Every run must pay for discovery, like a cold open(...) would
+    ngw::setDiscoveryCacheEnabled(false);
+
+    if (media_dir == nullptr) media_dir = g_strdup(g_get_tmp_dir());
+    g_mkdir_with_parents(media_dir, 0755);
+
+    if (trace != nullptr)
+    {
+        ngw::setTraceEnabled(true);
+        ngw::setTraceGstLatency(true);
+    }
+
+    gchar** selected = codecs != nullptr ? g_strsplit(codecs, ",", -1) : nullptr;
+    std::vector<Result> results;
+
+    for (const Codec& codec : CODECS)
+    {
+        if (selected != nullptr && !g_strv_contains(selected, codec.name)) continue;
+
+        GstElementFactory* factory = gst_element_factory_find(codec.encoder);
+        if (factory == nullptr)
+        {
+            fprintf(stderr, "Skipping %s, %s is not available.\n", codec.name, codec.encoder);
+            continue;
+        }
+        gst_object_unref(factory);
+
+        for (const Resolution& res : RESOLUTIONS)
+        {
+            gchar* name = g_strdup_printf("ngw.bench.%s.%dx%d.%d.%s",
+                codec.name, res.width, res.height, frames, codec.extension);
+            gchar* path = g_build_filename(media_dir, name, nullptr);
+            g_free(name);
+
+            fprintf(stderr, "Benchmarking %s...\n", path);
+
+            if (generate(codec, res, guint(frames), path))
+            {
+                results.push_back(run(codec, res, guint(frames), path));
+            }
+            else
+            {
+                Result failed;
+                failed.codec        = &codec;
+                failed.resolution   = res;
+                failed.expected     = guint(frames);
+                failed.error        = "unable to generate media";
+                results.push_back(failed);
+            }
+
+            g_free(path);
+        }
+    }
+
+    FILE* out = output != nullptr ? g_fopen(output, "w") : stdout;
+    if (out == nullptr)
+    {
+        fprintf(stderr, "Unable to write %s.\n", output);
+        out = stdout;
+    }
+
+    print(out, results);
+    if (out != stdout) fclose(out);
+
+    if (trace != nullptr && !ngw::dumpTrace(trace))
+    {
+        fprintf(stderr, "Unable to write %s.\n", trace);
+    }
+
+    g_strfreev(selected);
+    g_free(codecs);
+    g_free(output);
+    g_free(trace);
+    g_free(media_dir);
+    return 0;
+}